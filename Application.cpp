@@ -38,7 +38,11 @@ namespace ClassGame {
                 if (gameOver) {
                     ImGui::Text("Game Over!");
                     ImGui::Text("Winner: %d", gameWinner);
+                }
+                // available mid game too, so a long AI think can be called off
+                if (game && (gameOver || game->isAIThinking())) {
                     if (ImGui::Button("Reset Game")) {
+                        game->stopAI();
                         game->stopGame();
                         game->setUpBoard();
                         gameOver = false;
@@ -76,14 +80,18 @@ namespace ClassGame {
                         ImGui::Text("%s", stateString.substr(y*stride,stride).c_str());
                     }
                     ImGui::Text("Current Board State: %s", game->stateString().c_str());
+                    if (game->isAIThinking()) {
+                        ImGui::Text("AI thinking...");
+                    }
                 }
                 ImGui::End();
 
                 ImGui::Begin("GameWindow");
                 if (game) {
-                    if (game->gameHasAI() && (game->getCurrentPlayer()->isAIPlayer() || game->_gameOptions.AIvsAI))
+                    // the AI thinks in the background where the game supports it, the move lands on a later frame
+                    if (!gameOver && game->gameHasAI() && (game->getCurrentPlayer()->isAIPlayer() || game->_gameOptions.AIvsAI))
                     {
-                        game->updateAI();
+                        game->pollAI();
                     }
                     game->drawFrame();
                 }
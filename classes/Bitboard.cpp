@@ -0,0 +1,289 @@
+#include "Bitboard.h"
+#include <bit>
+#include <cstdlib>
+#include <cstring>
+#if !defined(_MSC_VER) && (defined(__x86_64__) || defined(__i386__))
+#include <cpuid.h>
+#define HAS_CPUID_H
+#endif
+
+uint64_t KnightAttacks[64];
+uint64_t KingAttacks[64];
+uint64_t PawnAttacks[2][64];
+uint64_t SquaresBetween[64][64];
+uint64_t LineThrough[64][64];
+
+Magic BishopMagics[64];
+Magic RookMagics[64];
+SliderBackend SliderBackendInUse = SliderMagic;
+
+// every relevant occupancy subset of every square, summed over the board, once in magic order and once in pext order
+static uint64_t _bishopAttackTable[5248];
+static uint64_t _rookAttackTable[102400];
+static uint64_t _bishopPextTable[5248];
+static uint64_t _rookPextTable[102400];
+
+static const int knightOffsets[8][2] = {  // all possible moveable positions as a knight
+    {2, 1}, {2, -1}, {-2, 1}, {-2, -1},
+    {1, 2}, {1, -2}, {-1, 2}, {-1, -2}
+};
+static const int kingOffsets[8][2] = {
+    {1, 0}, {1, 1}, {0, 1}, {-1, 1},
+    {-1, 0}, {-1, -1}, {0, -1}, {1, -1}
+};
+
+static const int pawnOffsets[2][2][2] = {
+    { {-1, 1}, {1, 1} },    // white captures up the board
+    { {-1, -1}, {1, -1} }   // black captures down it
+};
+
+static const int bishopDirections[4][2] = { {1, 1}, {1, -1}, {-1, 1}, {-1, -1} };
+static const int rookDirections[4][2]   = { {1, 0}, {-1, 0}, {0, 1}, {0, -1} };
+
+//
+// magic multipliers, one per square
+// found offline with a seeded sparse-random search; each one maps every occupancy subset of
+// its mask to a slot holding the right attack set, with no wasted bits beyond the mask size
+//
+static const uint64_t bishopMagicNumbers[64] = {
+    0x0C40484094008020ULL, 0x00A2500451024180ULL, 0x0021010C00830003ULL, 0x1009240100400010ULL,
+    0x5604042100800C02ULL, 0x020310180C000284ULL, 0x020C010813300210ULL, 0x4001012210044440ULL,
+    0x0032124208180090ULL, 0xC000245004510020ULL, 0x08AD9040A2044202ULL, 0x0000212040800208ULL,
+    0x0000840308042100ULL, 0x8420820804060000ULL, 0x5000010430028800ULL, 0x0A00090401412840ULL,
+    0x0A40044848980080ULL, 0x8020081044410044ULL, 0x09240A0820202200ULL, 0x1008000082004029ULL,
+    0x0851000820080000ULL, 0x1001000200410400ULL, 0x204400020084C400ULL, 0x1481000041080124ULL,
+    0x0064048040082838ULL, 0x001128255010810CULL, 0x0400E60210040840ULL, 0x20820024180080A0ULL,
+    0x4001001001004020ULL, 0x601101000808A800ULL, 0x0404148800480400ULL, 0x080C002026410C2AULL,
+    0xA092200402115004ULL, 0x8002029010208114ULL, 0x4004109000080042ULL, 0x1C00400820020200ULL,
+    0x000C0B0400060082ULL, 0x0248100C08704100ULL, 0x28B00200808220A0ULL, 0x0801010104102C00ULL,
+    0x1000900410012200ULL, 0x000C04829010A800ULL, 0x0021202030005801ULL, 0x000001A018000900ULL,
+    0x0101200410400400ULL, 0x1901017000802100ULL, 0x0182420404005128ULL, 0x085011020482402EULL,
+    0x008400A844100010ULL, 0x0402404818081002ULL, 0x2010010088D00000ULL, 0x2020040042020411ULL,
+    0x0022006020248000ULL, 0x0000082108008000ULL, 0x04100288080882A0ULL, 0x4190240844802072ULL,
+    0x0800802082202010ULL, 0x2018811404A20800ULL, 0x0200006042009002ULL, 0x0024105800840C40ULL,
+    0x0235800420020484ULL, 0x0000010820080090ULL, 0x0604106028210041ULL, 0x8082105008910040ULL
+};
+
+static const uint64_t rookMagicNumbers[64] = {
+    0x0080004000208011ULL, 0x2100102100804000ULL, 0x0080200080100008ULL, 0x0680061000800800ULL,
+    0x0200100200082004ULL, 0x2200010402001008ULL, 0x0080020000800100ULL, 0x0100002100038052ULL,
+    0x0000802040008000ULL, 0x0011002100804000ULL, 0x1210802000801008ULL, 0x0101000C20100101ULL,
+    0x0040808008000400ULL, 0x2202800400800200ULL, 0x0091003200110004ULL, 0x0490800040800100ULL,
+    0x508000C000200048ULL, 0x04E0004000300041ULL, 0x0030008010802000ULL, 0x1010008010800800ULL,
+    0x401C808008000400ULL, 0x0984008080040200ULL, 0x02000400C1121008ULL, 0x0020020024488104ULL,
+    0x4940802080004002ULL, 0x00C0100140200042ULL, 0x0002124100200101ULL, 0x8900084200201201ULL,
+    0x0008050100100800ULL, 0x0024000480800200ULL, 0x00081014002E0841ULL, 0x0400008200012844ULL,
+    0x4080002000400040ULL, 0x000080400080200AULL, 0x0010008010802000ULL, 0x0048041000800881ULL,
+    0x0000041101000800ULL, 0x0002000280800400ULL, 0x0202482104001012ULL, 0x0000440082000041ULL,
+    0x0180400080008020ULL, 0x9120005000204002ULL, 0x8088420082160020ULL, 0x0810100008008080ULL,
+    0x0001020800850010ULL, 0x6000400410680120ULL, 0x0090583002040081ULL, 0x10000100A0420004ULL,
+    0x8800804200210200ULL, 0x1000400880200480ULL, 0x4602028040201A00ULL, 0x1008801000480180ULL,
+    0x0000040080080080ULL, 0x0040040002008080ULL, 0x0020A20108104400ULL, 0x000104650C008200ULL,
+    0x2300800020190041ULL, 0x0004A481014001D7ULL, 0x8024204208120082ULL, 0x0029000905201001ULL,
+    0x4003000230480005ULL, 0xC101000208040001ULL, 0x0008421001080084ULL, 0x1120502084010052ULL
+};
+
+// if the offset position is a valid position on the board, mark it on the bitboard
+static uint64_t leaperAttacks(const int offsets[8][2], int square)
+{
+    uint64_t bitboard = 0ULL;
+    int column = square / 8;  // y value
+    int row = square % 8;     // x value
+    for (int i = 0; i < 8; i++) {
+        int x = row + offsets[i][0], y = column + offsets[i][1];
+        if (x >= 0 && x < 8 && y >= 0 && y < 8) {
+            bitboard |= 1ULL << (y * 8 + x);
+        }
+    }
+    return bitboard;
+}
+
+//
+// walk each ray from the square until it leaves the board or hits a blocker
+// only used to build the tables, never during move generation
+//
+static uint64_t slidingAttacks(const int directions[4][2], int square, uint64_t occupancy)
+{
+    uint64_t attacks = 0ULL;
+    for (int d = 0; d < 4; d++) {
+        int x = square % 8 + directions[d][0];
+        int y = square / 8 + directions[d][1];
+        while (x >= 0 && x < 8 && y >= 0 && y < 8) {
+            uint64_t bit = 1ULL << (y * 8 + x);
+            attacks |= bit;
+            if (occupancy & bit) {
+                break;
+            }
+            x += directions[d][0];
+            y += directions[d][1];
+        }
+    }
+    return attacks;
+}
+
+// squares on the board edge never block anything further along the ray, so leave them out of the mask
+static uint64_t relevantOccupancyMask(const int directions[4][2], int square)
+{
+    constexpr uint64_t Rank1 = 0x00000000000000FFULL;
+    constexpr uint64_t Rank8 = 0xFF00000000000000ULL;
+    constexpr uint64_t FileA = 0x0101010101010101ULL;
+    constexpr uint64_t FileH = 0x8080808080808080ULL;
+
+    uint64_t rankEdges = (Rank1 | Rank8) & ~(Rank1 << (8 * (square / 8)));
+    uint64_t fileEdges = (FileA | FileH) & ~(FileA << (square % 8));
+    return slidingAttacks(directions, square, 0ULL) & ~(rankEdges | fileEdges);
+}
+
+static void initSlider(Magic magics[64], uint64_t* table, uint64_t* pextTable, const uint64_t magicNumbers[64], const int directions[4][2])
+{
+    uint64_t* slice = table;
+    uint64_t* pextSlice = pextTable;
+    for (int square = 0; square < 64; square++) {
+        Magic& m = magics[square];
+        m.mask = relevantOccupancyMask(directions, square);
+        m.magic = magicNumbers[square];
+        m.shift = 64 - std::popcount(m.mask);
+        m.attacks = slice;
+        m.pextAttacks = pextSlice;
+
+        // enumerate all subsets of the mask (carry-rippler) and store the ray-walked attacks.
+        // subsets come out in counting order over the mask bits, which is exactly the pext index
+        uint64_t subset = 0ULL;
+        unsigned pextIndex = 0;
+        do {
+            uint64_t attacks = slidingAttacks(directions, square, subset);
+            m.attacks[m.index(subset)] = attacks;
+            m.pextAttacks[pextIndex++] = attacks;
+            subset = (subset - m.mask) & m.mask;
+        } while (subset);
+
+        slice += 1ULL << std::popcount(m.mask);
+        pextSlice += 1ULL << std::popcount(m.mask);
+    }
+}
+
+bool cpuHasBMI2()
+{
+    // leaf 7, subleaf 0, ebx bit 8
+#if defined(_MSC_VER)
+    int regs[4];
+    __cpuidex(regs, 0, 0);
+    if (regs[0] < 7) {
+        return false;
+    }
+    __cpuidex(regs, 7, 0);
+    return (regs[1] >> 8) & 1;
+#elif defined(HAS_CPUID_H)
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+        return false;
+    }
+    return (ebx >> 8) & 1;
+#else
+    return false;
+#endif
+}
+
+//
+// zen 1 and zen 2 report BMI2 but run pext in microcode at ~18 cycles per mask bit,
+// which is far slower than a multiply. only trust it on intel and on amd family 19h onwards
+//
+static bool cpuHasFastPext()
+{
+    if (!cpuHasBMI2()) {
+        return false;
+    }
+    unsigned int regs[4] = {};
+#if defined(_MSC_VER)
+    __cpuid((int*)regs, 0);
+#elif defined(HAS_CPUID_H)
+    __get_cpuid(0, &regs[0], &regs[1], &regs[2], &regs[3]);
+#endif
+    char vendor[13];
+    memcpy(vendor, &regs[1], 4);
+    memcpy(vendor + 4, &regs[3], 4);
+    memcpy(vendor + 8, &regs[2], 4);
+    vendor[12] = 0;
+    if (strcmp(vendor, "AuthenticAMD") != 0) {
+        return true;
+    }
+#if defined(_MSC_VER)
+    __cpuid((int*)regs, 1);
+#elif defined(HAS_CPUID_H)
+    __get_cpuid(1, &regs[0], &regs[1], &regs[2], &regs[3]);
+#endif
+    unsigned int family = ((regs[0] >> 8) & 0xF) + ((regs[0] >> 20) & 0xFF);
+    return family >= 0x19;
+}
+
+const char* sliderBackendName(SliderBackend backend)
+{
+    return backend == SliderPext ? "pext" : "magic";
+}
+
+void setSliderBackend(SliderBackend backend)
+{
+    if (backend == SliderPext && !cpuHasBMI2()) {
+        std::cout << "slider attacks: pext requested but the cpu has no BMI2, staying on magic" << std::endl;
+        backend = SliderMagic;
+    }
+    SliderBackendInUse = backend;
+    std::cout << "slider attacks: " << sliderBackendName(SliderBackendInUse) << std::endl;
+}
+
+void initMagicBitboards()
+{
+    static bool initialized = false;
+    if (initialized) {
+        return;
+    }
+    initSlider(BishopMagics, _bishopAttackTable, _bishopPextTable, bishopMagicNumbers, bishopDirections);
+    initSlider(RookMagics, _rookAttackTable, _rookPextTable, rookMagicNumbers, rookDirections);
+    initialized = true;
+
+    SliderBackend backend = cpuHasFastPext() ? SliderPext : SliderMagic;
+    const char* forced = std::getenv("CHESS_SLIDERS");
+    if (forced && strcmp(forced, "magic") == 0) {
+        backend = SliderMagic;
+    } else if (forced && strcmp(forced, "pext") == 0) {
+        backend = SliderPext;
+    }
+    setSliderBackend(backend);
+}
+
+void initAttackBitboards()
+{
+    for (int i = 0; i < 64; i++) {
+        KnightAttacks[i] = leaperAttacks(knightOffsets, i);
+        KingAttacks[i] = leaperAttacks(kingOffsets, i);
+        for (int color = 0; color < 2; color++) {
+            PawnAttacks[color][i] = 0ULL;
+            for (auto [dx, dy] : pawnOffsets[color]) {
+                int x = i % 8 + dx, y = i / 8 + dy;
+                if (x >= 0 && x < 8 && y >= 0 && y < 8) {
+                    PawnAttacks[color][i] |= 1ULL << (y * 8 + x);
+                }
+            }
+        }
+    }
+    initMagicBitboards();
+
+    // two squares share a line if each one's empty-board slider attacks reach the other
+    for (int a = 0; a < 64; a++) {
+        for (int b = 0; b < 64; b++) {
+            SquaresBetween[a][b] = 0ULL;
+            LineThrough[a][b] = 0ULL;
+            uint64_t aBit = 1ULL << a, bBit = 1ULL << b;
+            if (a == b) {
+                continue;
+            }
+            if (getRookAttacks<SliderMagic>(a, 0ULL) & bBit) {
+                SquaresBetween[a][b] = getRookAttacks<SliderMagic>(a, bBit) & getRookAttacks<SliderMagic>(b, aBit);
+                LineThrough[a][b] = (getRookAttacks<SliderMagic>(a, 0ULL) & getRookAttacks<SliderMagic>(b, 0ULL)) | aBit | bBit;
+            } else if (getBishopAttacks<SliderMagic>(a, 0ULL) & bBit) {
+                SquaresBetween[a][b] = getBishopAttacks<SliderMagic>(a, bBit) & getBishopAttacks<SliderMagic>(b, aBit);
+                LineThrough[a][b] = (getBishopAttacks<SliderMagic>(a, 0ULL) & getBishopAttacks<SliderMagic>(b, 0ULL)) | aBit | bBit;
+            }
+        }
+    }
+}
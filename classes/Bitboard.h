@@ -3,7 +3,12 @@
 #ifdef _MSC_VER
 #include <intrin.h>
 #endif
+#if defined(__BMI2__) || (defined(_MSC_VER) && defined(_M_X64))
+#include <immintrin.h>
+#endif
+#include <cstdint>
 #include <iostream>
+#include <string>
 
 enum ChessPiece
 {
@@ -73,24 +78,180 @@ private:
         unsigned long index;
         _BitScanForward64(&index, bb);
         return index;
+#else
+        return __builtin_ctzll(bb);
 #endif
     };
 
 };
 
+//
+// knight and king attacks only depend on the square, so they're one table load each
+//
+extern uint64_t KnightAttacks[64];
+extern uint64_t KingAttacks[64];
+// squares a pawn of the given color attacks from the square
+extern uint64_t PawnAttacks[2][64];
+
+// squares strictly between two squares on a shared rank, file or diagonal, 0 if they don't share one
+extern uint64_t SquaresBetween[64][64];
+// the whole rank, file or diagonal through two squares, 0 if they don't share one
+extern uint64_t LineThrough[64][64];
+
+// builds the knight, king and pawn tables, the slider tables below and the line tables, safe to call more than once
+void initAttackBitboards();
+
+//
+// sliding piece attacks
+// each square gets a relevant occupancy mask and a magic multiplier which hashes every
+// blocker arrangement on that mask to a slot in a precomputed attack table, so a lookup
+// is one and, one multiply, one shift and one load. the tables live in Bitboard.cpp
+//
+// on cpus with a fast BMI2 pext the mask bits are gathered straight into an index instead, which
+// needs no multiplier at all. both tables are built and one is picked at startup. the lookups are
+// templated on the backend so there's nothing to branch on per lookup: perft and the search check
+// SliderBackendInUse once and run the whole tree with the lookups for it
+//
+enum SliderBackend {
+    SliderMagic,
+    SliderPext
+};
+
+struct Magic {
+    uint64_t    mask;           // squares whose occupancy changes the attack set (board edges stripped)
+    uint64_t    magic;
+    uint64_t*   attacks;        // this square's slice of the shared attack table
+    uint64_t*   pextAttacks;    // same attack sets, ordered by pext index
+    unsigned    shift;          // 64 - number of bits in mask
+
+    unsigned index(uint64_t occupancy) const {
+        return (unsigned)(((occupancy & mask) * magic) >> shift);
+    }
+};
+
+extern Magic BishopMagics[64];
+extern Magic RookMagics[64];
+extern SliderBackend SliderBackendInUse;
+
+// fills the slider tables and picks a backend from cpuid, safe to call more than once
+// CHESS_SLIDERS=magic|pext in the environment overrides the pick
+void initMagicBitboards();
+// force a backend, for benchmarking. asking for pext on a cpu without BMI2 leaves it on magic.
+// not safe while a search or perft is running
+void setSliderBackend(SliderBackend backend);
+bool cpuHasBMI2();
+const char* sliderBackendName(SliderBackend backend);
+
+#if defined(__BMI2__) || (defined(_MSC_VER) && defined(_M_X64))
+inline uint64_t pextBits(uint64_t bits, uint64_t mask) { return _pext_u64(bits, mask); }
+#elif defined(__x86_64__)
+// the assembler takes pext whatever the compiler is targeting, so this still inlines into code built
+// without BMI2; it only ever runs once cpuid has said the instruction is there
+inline uint64_t pextBits(uint64_t bits, uint64_t mask)
+{
+    uint64_t result;
+    asm("pextq %2, %1, %0" : "=r"(result) : "r"(bits), "rm"(mask));
+    return result;
+}
+#else
+// no pext on this architecture, so the backend is never picked; this only keeps the templates building
+inline uint64_t pextBits(uint64_t bits, uint64_t mask)
+{
+    uint64_t result = 0ULL;
+    for (uint64_t bit = 1ULL; mask; bit <<= 1) {
+        if (bits & mask & -mask) {
+            result |= bit;
+        }
+        mask &= mask - 1;
+    }
+    return result;
+}
+#endif
+
+template <SliderBackend Backend>
+inline uint64_t sliderAttacks(const Magic& m, uint64_t occupancy) {
+    if constexpr (Backend == SliderPext) {
+        return m.pextAttacks[pextBits(occupancy, m.mask)];
+    } else {
+        return m.attacks[m.index(occupancy)];
+    }
+}
+
+template <SliderBackend Backend>
+inline uint64_t getBishopAttacks(int square, uint64_t occupancy) {
+    return sliderAttacks<Backend>(BishopMagics[square], occupancy);
+}
+
+template <SliderBackend Backend>
+inline uint64_t getRookAttacks(int square, uint64_t occupancy) {
+    return sliderAttacks<Backend>(RookMagics[square], occupancy);
+}
+
+template <SliderBackend Backend>
+inline uint64_t getQueenAttacks(int square, uint64_t occupancy) {
+    return getBishopAttacks<Backend>(square, occupancy) | getRookAttacks<Backend>(square, occupancy);
+}
+
+//
+// what kind of move a BitMove is
+// bit 2 marks captures and bit 3 promotions; for promotions the low two bits pick the piece
+//
+enum MoveFlags
+{
+    QuietMove               = 0,
+    DoublePawnPush          = 1,
+    KingCastle              = 2,
+    QueenCastle             = 3,
+    CaptureMove             = 4,
+    EnPassantCapture        = 5,
+    KnightPromotion         = 8,
+    BishopPromotion         = 9,
+    RookPromotion           = 10,
+    QueenPromotion          = 11,
+    KnightPromotionCapture  = 12,
+    BishopPromotionCapture  = 13,
+    RookPromotionCapture    = 14,
+    QueenPromotionCapture   = 15
+};
+
+//
+// a move packed into 16 bits: from square in bits 0-5, to square in bits 6-11, MoveFlags in 12-15.
+// the moving piece isn't stored, it's whatever stands on the from square. comparing two moves
+// is a single integer compare, and the transposition table stores the raw 16 bits as is
+//
 struct BitMove {
-    uint8_t from;
-    uint8_t to;
-    uint8_t piece;
-    
-    BitMove(int from, int to, ChessPiece piece)
-        : from(from), to(to), piece(piece) { }
-        
-    BitMove() : from(0), to(0), piece(NoPiece) { }
-    
-    bool operator==(const BitMove& other) const {
-        return from == other.from && 
-               to == other.to && 
-               piece == other.piece;
+    uint16_t data;
+
+    // left uninitialized so a MoveList doesn't clear all of its slots; BitMove{} is the empty move
+    BitMove() = default;
+    constexpr BitMove(int from, int to, int flags = QuietMove)
+        : data((uint16_t)(from | (to << 6) | (flags << 12))) { }
+    constexpr explicit BitMove(uint16_t packed)
+        : data(packed) { }
+
+    constexpr int from() const { return data & 63; }
+    constexpr int to() const { return (data >> 6) & 63; }
+    constexpr int flags() const { return data >> 12; }
+    constexpr uint16_t raw() const { return data; }
+    // a1a1 never happens, so all zero bits mean no move
+    constexpr bool isNone() const { return data == 0; }
+
+    constexpr bool isCapture() const { return flags() & CaptureMove; }
+    constexpr bool isPromotion() const { return flags() & KnightPromotion; }
+    constexpr bool isCastle() const { return flags() == KingCastle || flags() == QueenCastle; }
+    constexpr ChessPiece promotionPiece() const { return (ChessPiece)(Knight + (flags() & 3)); }
+
+    // long algebraic like e2e4 or e7e8q
+    std::string notation() const {
+        std::string s = { (char)('a' + from() % 8), (char)('1' + from() / 8), (char)('a' + to() % 8), (char)('1' + to() / 8) };
+        if (isPromotion()) {
+            s += "nbrq"[promotionPiece() - Knight];
+        }
+        return s;
     }
-};
\ No newline at end of file
+
+    constexpr bool operator==(const BitMove& other) const { return data == other.data; }
+    constexpr bool operator!=(const BitMove& other) const { return data != other.data; }
+};
+
+static_assert(sizeof(BitMove) == 2, "moves should pack into 16 bits");
@@ -1,4 +1,5 @@
 #include "Checkers.h"
+#include <cstdlib>
 
 Checkers::Checkers() : Game() {
     _grid = new Grid(8, 8);
@@ -63,10 +64,11 @@ bool Checkers::canBitMoveFrom(Bit &bit, BitHolder &src) {
     ChessSquare* square = static_cast<ChessSquare*>(&src);
     int x = square->getColumn();
     int y = square->getRow();
+    std::string state = stateString();
 
     // Must jump if available
-    if (hasJumpAvailable(bit.getOwner())) {
-        return canJumpFrom(*square);
+    if (checkersHasJump(state, bit.getOwner()->playerNumber())) {
+        return checkersCanJumpFrom(state, x, y);
     }
     return true;
 }
@@ -79,42 +81,22 @@ bool Checkers::canBitMoveFromTo(Bit& bit, BitHolder& src, BitHolder& dst) {
 
     int srcX = srcSquare->getColumn();
     int srcY = srcSquare->getRow();
+    int dstX = dstSquare->getColumn();
+    int dstY = dstSquare->getRow();
 
-    if (!_grid->isEnabled(dstSquare->getColumn(), dstSquare->getRow())) return false;
+    if (!_grid->isEnabled(dstX, dstY)) return false;
 
-    bool isKing = (bit.gameTag() == RED_KING || bit.gameTag() == YELLOW_KING);
-    bool isRed = (bit.getOwner() == getPlayerAt(RED_PLAYER));
+    std::string state = stateString();
 
     // Simple moves (if no jumps required)
-    if (!_mustContinueJumping && !hasJumpAvailable(bit.getOwner())) {
-        if (isKing) {
-            return dstSquare == _grid->getFL(srcX, srcY) || dstSquare == _grid->getFR(srcX, srcY) ||
-                   dstSquare == _grid->getBL(srcX, srcY) || dstSquare == _grid->getBR(srcX, srcY);
-        }
-        return isRed ? (dstSquare == _grid->getBL(srcX, srcY) || dstSquare == _grid->getBR(srcX, srcY)) :
-                       (dstSquare == _grid->getFL(srcX, srcY) || dstSquare == _grid->getFR(srcX, srcY));
+    if (!_mustContinueJumping && !checkersHasJump(state, bit.getOwner()->playerNumber())) {
+        return checkersIsStep(state, srcX, srcY, dstX, dstY);
     }
 
     // Jump moves
     if (_mustContinueJumping && &src != _jumpingPiece) return false;
 
-    // Check all jump directions
-    auto checkJump = [&](ChessSquare* middle, ChessSquare* target) -> bool {
-        if (!middle || !target || !middle->bit()) return false;
-        if (middle->bit()->getOwner() == bit.getOwner()) return false;
-        return dstSquare == target;
-    };
-
-    if (isKing || !isRed) {
-        if (checkJump(_grid->getFL(srcX, srcY), _grid->getFLFL(srcX, srcY))) return true;
-        if (checkJump(_grid->getFR(srcX, srcY), _grid->getFRFR(srcX, srcY))) return true;
-    }
-    if (isKing || isRed) {
-        if (checkJump(_grid->getBL(srcX, srcY), _grid->getBLBL(srcX, srcY))) return true;
-        if (checkJump(_grid->getBR(srcX, srcY), _grid->getBRBR(srcX, srcY))) return true;
-    }
-
-    return false;
+    return checkersIsJump(state, srcX, srcY, dstX, dstY);
 }
 
 void Checkers::bitMovedFromTo(Bit &bit, BitHolder &src, BitHolder &dst) {
@@ -128,34 +110,26 @@ void Checkers::bitMovedFromTo(Bit &bit, BitHolder &src, BitHolder &dst) {
 
     // Check for jump
     ChessSquare* jumped = nullptr;
-    if (dstSquare == _grid->getFLFL(srcX, srcY)) jumped = _grid->getFL(srcX, srcY);
-    else if (dstSquare == _grid->getFRFR(srcX, srcY)) jumped = _grid->getFR(srcX, srcY);
-    else if (dstSquare == _grid->getBLBL(srcX, srcY)) jumped = _grid->getBL(srcX, srcY);
-    else if (dstSquare == _grid->getBRBR(srcX, srcY)) jumped = _grid->getBR(srcX, srcY);
+    if (std::abs(dstX - srcX) == 2) jumped = _grid->getSquare((srcX + dstX) / 2, (srcY + dstY) / 2);
+
+    // Promotion check
+    int promoted = checkersPromoted(bit.gameTag(), dstY);
+    if (promoted != bit.gameTag()) {
+        bit.setGameTag(promoted);
+        bit.setScale(1.3f);
+    }
 
     if (jumped && jumped->bit()) {
         // Capture
         (jumped->bit()->getOwner() == getPlayerAt(RED_PLAYER)) ? _redPieces-- : _yellowPieces--;
         jumped->destroyBit();
 
-        // Promotion check
-        if ((bit.gameTag() == RED_PIECE && dstY == 7) || (bit.gameTag() == YELLOW_PIECE && dstY == 0)) {
-            bit.setGameTag(bit.gameTag() == RED_PIECE ? RED_KING : YELLOW_KING);
-            bit.setScale(1.3f);
-        }
-
         // Check for more jumps
-        if (canJumpFrom(*dstSquare)) {
+        if (checkersCanJumpFrom(stateString(), dstX, dstY)) {
             _mustContinueJumping = true;
             _jumpingPiece = &dst;
             return;
         }
-    } else {
-        // Regular move - promotion check
-        if ((bit.gameTag() == RED_PIECE && dstY == 7) || (bit.gameTag() == YELLOW_PIECE && dstY == 0)) {
-            bit.setGameTag(bit.gameTag() == RED_PIECE ? RED_KING : YELLOW_KING);
-            bit.setScale(1.3f);
-        }
     }
 
     _mustContinueJumping = false;
@@ -163,84 +137,14 @@ void Checkers::bitMovedFromTo(Bit &bit, BitHolder &src, BitHolder &dst) {
     endTurn();
 }
 
-bool Checkers::canJumpFrom(ChessSquare& square) const {
-    Bit* piece = square.bit();
-    if (!piece) return false;
-
-    int x = square.getColumn();
-    int y = square.getRow();
-    bool isKing = (piece->gameTag() == RED_KING || piece->gameTag() == YELLOW_KING);
-    bool isRed = (piece->getOwner() == getPlayerAt(RED_PLAYER));
-    Player* player = piece->getOwner();
-
-    auto checkJumpDir = [&](ChessSquare* middle, ChessSquare* target) -> bool {
-        return middle && middle->bit() && middle->bit()->getOwner() != player &&
-               target && !target->bit();
-    };
-
-    if (isKing || !isRed) {
-        if (checkJumpDir(_grid->getFL(x, y), _grid->getFLFL(x, y))) return true;
-        if (checkJumpDir(_grid->getFR(x, y), _grid->getFRFR(x, y))) return true;
-    }
-    if (isKing || isRed) {
-        if (checkJumpDir(_grid->getBL(x, y), _grid->getBLBL(x, y))) return true;
-        if (checkJumpDir(_grid->getBR(x, y), _grid->getBRBR(x, y))) return true;
-    }
-    return false;
-}
-
-bool Checkers::hasJumpAvailable(Player* player) const {
-    bool hasJump = false;
-    _grid->forEachEnabledSquare([&](ChessSquare* square, int x, int y) {
-        if (hasJump) return;
-        Bit* piece = square->bit();
-        if (piece && piece->getOwner() == player) {
-            Checkers* self = const_cast<Checkers*>(this);
-            if (self->canJumpFrom(*square)) {
-                hasJump = true;
-            }
-        }
-    });
-    return hasJump;
-}
-
 Player* Checkers::checkForWinner() {
     if (_redPieces == 0) return getPlayerAt(YELLOW_PLAYER);
     if (_yellowPieces == 0) return getPlayerAt(RED_PLAYER);
 
     // Check if current player has any moves
-    Player* current = getCurrentPlayer();
-    bool hasMove = false;
-
-    _grid->forEachEnabledSquare([&](ChessSquare* square, int x, int y) {
-        if (hasMove) return;
-        Bit* piece = square->bit();
-        if (piece && piece->getOwner() == current) {
-            bool isKing = (piece->gameTag() == RED_KING || piece->gameTag() == YELLOW_KING);
-            bool isRed = (current == getPlayerAt(RED_PLAYER));
-
-            // Check for any valid move
-            auto checkMove = [&](ChessSquare* target) {
-                if (target && !target->bit()) hasMove = true;
-            };
-
-            if (isKing) {
-                checkMove(_grid->getFL(x, y));
-                checkMove(_grid->getFR(x, y));
-                checkMove(_grid->getBL(x, y));
-                checkMove(_grid->getBR(x, y));
-            } else if (isRed) {
-                checkMove(_grid->getBL(x, y));
-                checkMove(_grid->getBR(x, y));
-            } else {
-                checkMove(_grid->getFL(x, y));
-                checkMove(_grid->getFR(x, y));
-            }
-        }
-    });
-
-    if (!hasMove) {
-        return current == getPlayerAt(RED_PLAYER) ? getPlayerAt(YELLOW_PLAYER) : getPlayerAt(RED_PLAYER);
+    int current = getCurrentPlayer()->playerNumber();
+    if (!checkersHasMove(stateString(), current)) {
+        return getPlayerAt(current == RED_PLAYER ? YELLOW_PLAYER : RED_PLAYER);
     }
     return nullptr;
 }
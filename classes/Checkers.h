@@ -1,5 +1,6 @@
 #pragma once
 #include "Game.h"
+#include "CheckersRules.h"
 
 // NOTE: If Square class needs modifications to support colored squares for checkerboard pattern,
 // add a method like setColor(ImVec4 color) to Square class
@@ -29,29 +30,8 @@ public:
     Grid* getGrid() override { return _grid; }
 
 private:
-    // Constants for piece types
-    static const int EMPTY = 0;
-    static const int RED_PIECE = 1;
-    static const int RED_KING = 2;
-    static const int YELLOW_PIECE = 3;
-    static const int YELLOW_KING = 4;
-
-    // Player constants
-    static const int RED_PLAYER = 0;
-    static const int YELLOW_PLAYER = 1;
-
     // Helper methods
     Bit*        createPiece(int pieceType);
-    int         getPieceType(const Bit& bit) const;
-    bool        isKing(const Bit& bit) const;
-    bool        isValidMove(int srcX, int srcY, int dstX, int dstY, Player* player) const;
-    bool        isJumpMove(int srcX, int srcY, int dstX, int dstY) const;
-    bool        hasJumpAvailable(Player* player) const;
-    bool        canJumpFrom(ChessSquare& square) const;
-    void        performJump(int srcX, int srcY, int dstX, int dstY);
-    void        promoteToKing(Bit& bit, int y);
-    void        getBoardPosition(BitHolder &holder, int &x, int &y) const;
-    bool        isValidSquare(int x, int y) const;
 
     // Board representation
     Grid*        _grid;
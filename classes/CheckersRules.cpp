@@ -0,0 +1,116 @@
+#include "CheckersRules.h"
+
+static bool isDarkSquare(int x, int y)
+{
+    return x >= 0 && x < 8 && y >= 0 && y < 8 && (x + y) % 2 == 1;
+}
+
+int checkersPieceAt(const std::string& state, int x, int y)
+{
+    if (!isDarkSquare(x, y)) {
+        return EMPTY;
+    }
+    // four dark squares a row
+    return state[y * 4 + x / 2] - '0';
+}
+
+int checkersOwner(int piece)
+{
+    if (piece == RED_PIECE || piece == RED_KING) {
+        return RED_PLAYER;
+    }
+    if (piece == YELLOW_PIECE || piece == YELLOW_KING) {
+        return YELLOW_PLAYER;
+    }
+    return -1;
+}
+
+int checkersPromoted(int piece, int y)
+{
+    if (piece == RED_PIECE && y == 7) {
+        return RED_KING;
+    }
+    if (piece == YELLOW_PIECE && y == 0) {
+        return YELLOW_KING;
+    }
+    return piece;
+}
+
+// men only go forward, red down the rows and yellow up them
+static bool canMoveTowards(int piece, int dy)
+{
+    if (piece == RED_KING || piece == YELLOW_KING) {
+        return true;
+    }
+    return piece == RED_PIECE ? dy > 0 : dy < 0;
+}
+
+bool checkersIsStep(const std::string& state, int srcX, int srcY, int dstX, int dstY)
+{
+    int piece = checkersPieceAt(state, srcX, srcY);
+    int dx = dstX - srcX, dy = dstY - srcY;
+    if (piece == EMPTY || (dx != 1 && dx != -1) || (dy != 1 && dy != -1) || !canMoveTowards(piece, dy)) {
+        return false;
+    }
+    return isDarkSquare(dstX, dstY) && checkersPieceAt(state, dstX, dstY) == EMPTY;
+}
+
+bool checkersIsJump(const std::string& state, int srcX, int srcY, int dstX, int dstY)
+{
+    int piece = checkersPieceAt(state, srcX, srcY);
+    int dx = dstX - srcX, dy = dstY - srcY;
+    if (piece == EMPTY || (dx != 2 && dx != -2) || (dy != 2 && dy != -2) || !canMoveTowards(piece, dy)) {
+        return false;
+    }
+    int jumped = checkersPieceAt(state, srcX + dx / 2, srcY + dy / 2);
+    if (jumped == EMPTY || checkersOwner(jumped) == checkersOwner(piece)) {
+        return false;
+    }
+    return isDarkSquare(dstX, dstY) && checkersPieceAt(state, dstX, dstY) == EMPTY;
+}
+
+bool checkersCanJumpFrom(const std::string& state, int x, int y)
+{
+    return checkersIsJump(state, x, y, x - 2, y - 2) || checkersIsJump(state, x, y, x + 2, y - 2) ||
+           checkersIsJump(state, x, y, x - 2, y + 2) || checkersIsJump(state, x, y, x + 2, y + 2);
+}
+
+static bool canStepFrom(const std::string& state, int x, int y)
+{
+    return checkersIsStep(state, x, y, x - 1, y - 1) || checkersIsStep(state, x, y, x + 1, y - 1) ||
+           checkersIsStep(state, x, y, x - 1, y + 1) || checkersIsStep(state, x, y, x + 1, y + 1);
+}
+
+bool checkersHasJump(const std::string& state, int player)
+{
+    for (int y = 0; y < 8; y++) {
+        for (int x = 1 - y % 2; x < 8; x += 2) {
+            if (checkersOwner(checkersPieceAt(state, x, y)) == player && checkersCanJumpFrom(state, x, y)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool checkersHasMove(const std::string& state, int player)
+{
+    for (int y = 0; y < 8; y++) {
+        for (int x = 1 - y % 2; x < 8; x += 2) {
+            if (checkersOwner(checkersPieceAt(state, x, y)) == player &&
+                (canStepFrom(state, x, y) || checkersCanJumpFrom(state, x, y))) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+int checkersCount(const std::string& state, int player)
+{
+    int count = 0;
+    for (char cell : state) {
+        count += checkersOwner(cell - '0') == player;
+    }
+    return count;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "GameRules.h"
+#include <string>
+
+//
+// checkers rules on the state string alone, no sprites or textures
+// the state is 32 characters, one per dark square, row by row from the top, holding the piece's type.
+// red (player 0) starts at the top and moves down the board, yellow (player 1) starts at the bottom
+// and moves up; kings move both ways. a man that reaches the far row is crowned
+//
+const int EMPTY = 0;
+const int RED_PIECE = 1;
+const int RED_KING = 2;
+const int YELLOW_PIECE = 3;
+const int YELLOW_KING = 4;
+
+const int RED_PLAYER = 0;
+const int YELLOW_PLAYER = 1;
+
+// the piece type on x, y; EMPTY for empty, light or off board squares
+int checkersPieceAt(const std::string& state, int x, int y);
+// RED_PLAYER or YELLOW_PLAYER, -1 for EMPTY
+int checkersOwner(int piece);
+// the piece after landing on row y, a king if a man just reached the far row
+int checkersPromoted(int piece, int y);
+
+// one diagonal step in a direction the piece on the source square may move, onto an empty square
+bool checkersIsStep(const std::string& state, int srcX, int srcY, int dstX, int dstY);
+// two diagonal steps over an opponent's piece onto an empty square
+bool checkersIsJump(const std::string& state, int srcX, int srcY, int dstX, int dstY);
+bool checkersCanJumpFrom(const std::string& state, int x, int y);
+// a jump is compulsory whenever the player has one
+bool checkersHasJump(const std::string& state, int player);
+// any step or jump at all; a player without one has lost
+bool checkersHasMove(const std::string& state, int player);
+int checkersCount(const std::string& state, int player);
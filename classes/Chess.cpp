@@ -1,14 +1,20 @@
 #include "Chess.h"
+#include "Material.h"
 #include <limits>
 #include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
 
 Chess::Chess()
 {
     _grid = new Grid(8, 8);
+    _aiClock = 0;
 }
 
 Chess::~Chess()
 {
+    stopAI();
     delete _grid;
 }
 
@@ -16,10 +22,10 @@ char Chess::pieceNotation(int x, int y) const
 {
     const char *wpieces = { "0PNBRQK" };
     const char *bpieces = { "0pnbrqk" };
-    Bit *bit = _grid->getSquare(x, y)->bit();
+    uint8_t tag = _position.board[y * 8 + x];
     char notation = '0';
-    if (bit) {
-        notation = bit->gameTag() < 128 ? wpieces[bit->gameTag()] : bpieces[bit->gameTag()-128];
+    if (tag) {
+        notation = tag < 128 ? wpieces[tag] : bpieces[tag-128];
     }
     return notation;
 }
@@ -46,121 +52,67 @@ void Chess::setUpBoard()
     _gameOptions.rowY = 8;
 
     _grid->initializeChessSquares(pieceSize, "boardsquare.png");
-    FENtoBoard("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR");
+    // generate moves for each position on the board
+    initAttackBitboards();
+    // evaluate with a network if there's one beside the textures (or wherever CHESS_NNUE points),
+    // otherwise the piece-square tables do. it has to be loaded before the position is set up.
+    // no chess.nnue is the usual case, so only a network asked for by name complains when it's missing
+    if (!nnueNetwork()) {
+        const char* network = std::getenv("CHESS_NNUE");
+        if (network) {
+            loadNnue(network);
+        } else if (std::filesystem::exists("chess.nnue")) {
+            loadNnue("chess.nnue");
+        }
+    }
+
+    FENtoBoard("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
     
     // TEST CAPTURE
     //FENtoBoard("8/8/3N4/8/1K2n3/3P4/5P2/k7");
-    
-    // generate moves for each position on the board
-    for (int i = 0; i < 64; i++) {
-        _knightBitBoards[i] = generateKnightMoveBitBoard(i);
-        _kingBitBoards[i] = generateKingMoveBitBoard(i);
-    }
 
     _moves = generateAllMoves();
 
+    if (gameHasAI()) {
+        setAIPlayer(AI_PLAYER);
+    }
+    _gameOptions.AIMAXDepth = 5;
+    // five minutes a game plus two seconds a move
+    _gameOptions.AITimeControl = 5 * 60 * 1000;
+    _gameOptions.AIIncrement = 2000;
+    _aiClock = _gameOptions.AITimeControl;
+    // leave a core for the window
+    _search.setThreads(std::max(1, (int)std::thread::hardware_concurrency() - 1));
+    // a new game starts with an empty table
+    _search.transpositionTable().resize(ChessHashMegabytes);
+
     startGame();
 }
 
 void Chess::FENtoBoard(const std::string& fen) {
-    // convert a FEN string to a board
-
-    _grid->forEachSquare([](ChessSquare* square, int x, int y) {
-        square->setBit(nullptr);
-    });
+    // convert a FEN string into _position, then build the sprites from it
+    if (!_position.setFEN(fen)) {
+        std::cout << "bad FEN: " << fen << std::endl;
+    }
+    syncBitsFromPosition();
+}
 
-    int y = _grid->getHeight()-1;
-    int x = 0;
-    for (char fen_char : fen) {
-        // go to next row when reaching
-        // - '/' for a new row on the board
-        // - ' ' for breaks in notation between boardstate, castling, enpessant, etc.
-        if (fen_char == '/' || fen_char == ' ') {
-            y--;
-            // when y >= 0, the function is searching for spaces on the board
-            // when y < 0, the function is searching for castling, enpessant, and other notations
-            // y = -1 | set turn for player
-            // y = -2 | set castling availability for each player
-            // y = -3 | determine enpessant availability
-            // y = -4 | half moves
-            // y = -5 | full moves
-            x = 0;
-            continue;
+void Chess::syncBitsFromPosition()
+{
+    _grid->forEachSquare([&](ChessSquare* square, int x, int y) {
+        uint8_t tag = _position.board[y * 8 + x];
+        Bit* bit = square->bit();
+        if (bit && bit->gameTag() == tag) {
+            return;
         }
-
-        // create a bit, and assign it to a square at the given x, y
-        Bit *bit = nullptr;
-        char fen_lower = tolower(fen_char);
-        // check if character matches a piece
-        // set the correct piece image for the bit
-        if (y >= 0) {
-            if (!isdigit(fen_char)) {
-                ChessPiece piece = Pawn;
-                switch(fen_lower) {
-                    case 'p':
-                        break;
-                    case 'r':
-                        piece = Rook;
-                        break;
-                    case 'n':
-                        piece = Knight;
-                        break;
-                    case 'b':
-                        piece = Bishop;
-                        break;
-                    case 'q':
-                        piece = Queen;
-                        break;
-                    case 'k':
-                        piece = King;
-                        break;   
-                } 
-                bit = PieceForPlayer(std::isupper(fen_char) ? 0 : 1, piece);
-                BitHolder* curr_square = _grid->getSquare(x, y);
-                bit->setPosition(curr_square->getPosition());
-                curr_square->setBit(bit);
-
-                // move one column to the right after each iteration by default
-                x += 1;
-            }
-            // check for numbers 
-            else { 
-                x += fen_char - '0';
-                // skip columns based on fen_char number
-                // -1 to offset for default x move
-            }
-        } else if (y == -1) {  // check turn
-            if (fen_lower == 'w') {
-                // white to move
-            } else if (fen_lower == 'b') {  
-                // black to move
-            }
-        } else if (y == -2) {
-            if (fen_lower == 'q') {
-                // set castle rules
-            } else if (fen_lower == 'k') {
-                // set castle rules
-            } else if (fen_lower == '-') {
-                // nobody can castle
-            }
-        } else if (y == -3) {  // en pessant rules
-            if (fen_lower == '-') {
-                // no enpessant
-            }
-        }  else if (y == -4) {
-            // half move
-        } else if (y == -5) {
-            // full move
+        if (!tag) {
+            square->setBit(nullptr);
+            return;
         }
-    }
-
-    // for (int i = 0; i < 64; i ++) {
-    //     x = i%8;
-    //     y = i/8;
-    //     std::cout << _grid->getSquare(x,y)->gameTag() << " at: " << x << ", " << y << std::endl;
-    // }
-
-
+        bit = PieceForPlayer(tagColor(tag), tagPiece(tag));
+        bit->setPosition(square->getPosition());
+        square->setBit(bit);
+    });
 }
 
 bool Chess::actionForEmptyHolder(BitHolder &holder)
@@ -168,12 +120,33 @@ bool Chess::actionForEmptyHolder(BitHolder &holder)
     return false;
 }
 
+//
+// the sprite has already been dropped on dst, so play the move on _position and
+// let the sprites catch up with anything else it did (castling rook, en passant, promotion)
+//
+void Chess::bitMovedFromTo(Bit &bit, BitHolder &src, BitHolder &dst)
+{
+    int from = ((ChessSquare *)&src)->getSquareIndex();
+    int to = ((ChessSquare *)&dst)->getSquareIndex();
+
+    for (auto move : _moves) {
+        // there's no promotion picker yet, so a pawn reaching the end always becomes a queen
+        if (move.from() == from && move.to() == to && (!move.isPromotion() || move.promotionPiece() == Queen)) {
+            _position.makeMove(move);
+            break;
+        }
+    }
+    syncBitsFromPosition();
+
+    Game::bitMovedFromTo(bit, src, dst);
+}
+
 bool Chess::canBitMoveFrom(Bit &bit, BitHolder &src)
 {
-    // need to implement friendly/unfriendly in bit so for now this hack
-    int currentPlayer = getCurrentPlayer()->playerNumber() * 128;
-    int pieceColor = bit.gameTag() & 128;
-    // if (pieceColor == currentPlayer) return true;
+    // only the player to move's own pieces, and never while a search is running on the position
+    if (isAIThinking() || bit.getOwner() != getCurrentPlayer()) {
+        return false;
+    }
 
     bool ret = false;
     ChessSquare* square = (ChessSquare *)&src;
@@ -181,9 +154,9 @@ bool Chess::canBitMoveFrom(Bit &bit, BitHolder &src)
         // highlight each square which the piece can move to
         int squareIndex = square->getSquareIndex();
         for (auto move : _moves) {
-            if (move.from == squareIndex) {
+            if (move.from() == squareIndex) {
                 ret = true;
-                ChessSquare* dest = _grid->getSquareByIndex(move.to);
+                ChessSquare* dest = _grid->getSquareByIndex(move.to());
                 dest->setHighlighted(true);
             }
         }
@@ -199,7 +172,7 @@ bool Chess::canBitMoveFromTo(Bit &bit, BitHolder &src, BitHolder &dst)
         // if one of the moves is the destination square, return true
         int squareIndex = square->getSquareIndex();
         for (auto move : _moves) {
-            if (move.from == fromIndex && move.to == squareIndex) {
+            if (move.from() == fromIndex && move.to() == squareIndex) {
                 return true;
             }
         }
@@ -230,12 +203,21 @@ Player* Chess::ownerAt(int x, int y) const
 Player* Chess::checkForWinner()
 {
     _moves = generateAllMoves();
+    // checkmated: the side to move has no moves and is in check
+    if (_moves.empty() && _position.inCheck()) {
+        return getPlayerAt(_position.sideToMove ^ 1);
+    }
     return nullptr;
 }
 
+// stalemate, the fifty move rule, a repetition, or nobody left with enough to mate
 bool Chess::checkForDraw()
 {
-    return false;
+    // checkForWinner always runs first and leaves _moves fresh
+    if (_moves.empty() && !_position.inCheck()) {
+        return true;
+    }
+    return _position.isDrawByGameRule() || isInsufficientMaterial(_position);
 }
 
 std::string Chess::initialStateString()
@@ -245,233 +227,82 @@ std::string Chess::initialStateString()
 
 std::string Chess::stateString()
 {
-    
-    std::string s;
-    s.reserve(64);
-    _grid->forEachSquare([&](ChessSquare* square, int x, int y) {
-            s += pieceNotation( x, y );
-        }
-    );
-    //std::cout << "creating state string: " << s << std::endl;
-    return s;}
+    std::string s(64, '0');
+    for (int index = 0; index < 64; index++) {
+        s[index] = pieceNotation(index % 8, index / 8);
+    }
+    return s;
+}
 
 void Chess::setStateString(const std::string &s)
 {
     std::cout << "setting state string" << std::endl;
-    _grid->forEachSquare([&](ChessSquare* square, int x, int y) {
-        int index = y * 8 + x;
-        char playerNumber = s[index] - '0';
-        if (playerNumber) {
-            square->setBit(PieceForPlayer(playerNumber - 1, Pawn));
-        } else {
-            square->setBit(nullptr);
+    const char *notation = { "0pnbrqk" };
+    for (int index = 0; index < 64 && index < (int)s.size(); index++) {
+        _position.removePiece(index);
+        const char *found = strchr(notation, tolower(s[index]));
+        if (found && *found != '0') {
+            _position.putPiece(isupper(s[index]) ? White : Black, (ChessPiece)(found - notation), index);
         }
-    });
+    }
+    _position.key = _position.computeKey();
+    // the moves that led here are gone, and so are the network's incremental sums
+    _position.undoStack.clear();
+    _position.resetAccumulators();
+    syncBitsFromPosition();
 }
 
-#pragma region Chess Piece Movement
-
-std::vector<BitMove> Chess::generateAllMoves()
+//
+// the AI thinks on _position; the sprites only catch up once it has picked a move
+//
+void Chess::updateAI()
 {
-    std::vector<BitMove> moves;
-    moves.reserve(32);
-    std::string state = stateString();
-
-    uint64_t whiteKnights = 0LL;
-    uint64_t whitePawns = 0LL;
-    unsigned int whiteKingPos = 65;  // only save a singular int value for the index of the king
-    uint64_t whiteBishops = 0LL;
-    uint64_t whiteRooks = 0LL;
-    uint64_t whiteQueens = 0LL;
-
-    uint64_t blackKnights = 0LL;
-    uint64_t blackPawns = 0LL;
-    unsigned int blackKingPos = 65;
-    uint64_t blackBishops = 0LL;
-    uint64_t blackRooks = 0LL;
-    uint64_t blackQueens = 0LL;
-
-    for (int i = 0; i < 64; i++) {
-        char fen_char = state[i];
-        switch(tolower(fen_char)) {
-            case 'p':
-                isupper(fen_char) ? whitePawns |= 1ULL << i : blackPawns |= 1ULL << i;
-                break;
-            case 'r':
-                isupper(fen_char) ? whiteRooks |= 1ULL << i : blackRooks |= 1ULL << i;
-                break;
-            case 'n':
-                isupper(fen_char) ? whiteKnights |= 1ULL << i : blackKnights |= 1ULL << i;
-                break;
-            case 'b':
-                isupper(fen_char) ? whiteBishops |= 1ULL << i : blackBishops |= 1ULL << i;
-                break;
-            case 'q':
-                isupper(fen_char) ? whiteQueens |= 1ULL << i : blackQueens |= 1ULL << i;
-                break;
-            case 'k':
-                isupper(fen_char) ? whiteKingPos = i : blackKingPos = i;
-                break;   
-        } 
-    }
-    uint64_t w_occupancy = whiteKnights | whitePawns | ((uint64_t)0ULL | 1ULL << whiteKingPos) | whiteBishops | whiteRooks | whiteQueens;
-    uint64_t b_occupancy = blackKnights | blackPawns | ((uint64_t)0ULL | 1ULL << blackKingPos) | blackBishops | blackRooks | blackQueens;
-    uint64_t total_occupancy = w_occupancy | b_occupancy;
-    // player number 0 for white, 1 for black
-    if (getCurrentPlayer()->playerNumber() == 0) {
-        // white to move
-        generateKnightMoves(moves, whiteKnights, ~w_occupancy);
-        generateKingMoves(moves, whiteKingPos, ~w_occupancy);
-        generatePawnMoves(moves, whitePawns, ~total_occupancy, b_occupancy, WHITE);
-    } else {
-        // black to move
-        generateKnightMoves(moves, blackKnights, ~b_occupancy);
-        generateKingMoves(moves, blackKingPos, ~b_occupancy);
-        generatePawnMoves(moves, blackPawns, ~total_occupancy, w_occupancy, BLACK);
-    }
-
-
-    std::cout << moves.size() << std::endl;
-    return moves;
+    prepareAI();
+    applyAIMove(thinkAI());
 }
 
-#pragma region Knight FX
-
-BitBoard Chess::generateKnightMoveBitBoard(int square) {
-    // create an empty bitboard
-    BitBoard bitboard = 0ULL;
-    int column = square / 8;  // y value
-    int row = square % 8;     // x value
-
-    constexpr uint64_t oneBit = 1;
-    // if the offset position is a valid position on the board, mark it on the bitboard
-    for (auto [dx, dy] : knightOffsets) {
-        int x = row + dx, y = column + dy;
-        if (x >= 0 && x < 8 && y >= 0 && y < 8) {
-            // shift the 1 bit onto the respective place on the board relative to its on-board index
-            bitboard |= oneBit << (y * 8 + x);
-        }
+void Chess::prepareAI()
+{
+    _aiPosition = _position;
+    _aiLimits = SearchLimits{};
+    if (_gameOptions.AITimeControl > 0) {
+        // out of time only means playing fast; there's no flag to fall here
+        _aiLimits.time = std::max<int64_t>(_aiClock, 1);
+        _aiLimits.increment = _gameOptions.AIIncrement;
+    } else {
+        _aiLimits.depth = getAIMAXDepth();
     }
-
-    return bitboard;
+    _aiThinkStart = std::chrono::steady_clock::now();
 }
 
-void Chess::generateKnightMoves(std::vector<BitMove>& moves, BitBoard knightBoard, uint64_t empty_squares) {
-    knightBoard.forEachBit([&](int fromSquare) {
-        BitBoard moveBitboard = BitBoard(_knightBitBoards[fromSquare].getData() & empty_squares);
-        // Efficiently iterate through only the set bits
-        moveBitboard.forEachBit([&](int toSquare) {
-           moves.emplace_back(fromSquare, toSquare, Knight);
-        });
-    });
-}
-
-#pragma endregion
-
-#pragma region King FX
-
-BitBoard Chess::generateKingMoveBitBoard(int square) {
-    // create an empty bitboard
-    BitBoard bitboard = 0ULL;
-    int column = square / 8;  // y value
-    int row = square % 8;     // x value
-
-    constexpr uint64_t oneBit = 1;
-    // if the offset position is a valid position on the board, mark it on the bitboard
-    for (auto [dx, dy] : kingOffsets) {
-        int x = row + dx, y = column + dy;
-        if (x >= 0 && x < 8 && y >= 0 && y < 8) {
-            // shift the 1 bit onto the respective place on the board relative to its on-board index
-            bitboard |= oneBit << (y * 8 + x);
-        }
-    }
-
-    return bitboard;
+int Chess::thinkAI()
+{
+    SearchResult result = _search.think(_aiPosition, _aiLimits);
+    return result.bestMove.isNone() ? -1 : result.bestMove.raw();
 }
 
-void Chess::generateKingMoves(std::vector<BitMove>& moves, unsigned int kingPos, uint64_t empty_squares){
-    if (kingPos == 65) { // no king, so return
+void Chess::applyAIMove(int move)
+{
+    // the answer is stale if the board changed under the search
+    if (move < 0 || _position.key != _aiPosition.key || !_position.isLegal(BitMove((uint16_t)move))) {
         return;
     }
-    BitBoard moveBitboard = BitBoard(_kingBitBoards[kingPos].getData() & empty_squares);
-    // Efficiently iterate through only the set bits
-    moveBitboard.forEachBit([&](int toSquare) {
-        moves.emplace_back(kingPos, toSquare, Knight);
-    });
-}
-
-#pragma endregion
-
-#pragma region Pawn FX
-
-void Chess::generatePawnMoves(std::vector<BitMove>& moves, BitBoard pawnBoard, BitBoard empty_squares,
-     BitBoard enemyPieces, char color) {
-    if (pawnBoard.getData() == 0) {  // no pawns
-        return;
+    if (_gameOptions.AITimeControl > 0) {
+        int64_t spent = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - _aiThinkStart).count();
+        _aiClock = std::max<int64_t>(_aiClock - spent, 0) + _gameOptions.AIIncrement;
     }
-
-    // define row & column masks for specific pawn cases
-    constexpr uint64_t NotCol1(0xFEFEFEFEFEFEFEFEULL);  // mask along the first column
-    constexpr uint64_t NotCol8(0x7F7F7F7F7F7F7F7FULL);  // mask along the last column
-    constexpr uint64_t Row3(0x0000000000FF0000ULL);     // mask on the 3rd row
-    constexpr uint64_t Row6(0x0000FF0000000000ULL);     // mask on the 6th row
-
-    // Calculate single moves
-    // shift bits LEFT to push white up the board. otherwise, shift bits RIGHT to push black down the board
-    BitBoard singleMoves = color == WHITE ? 
-    (pawnBoard.getData() << 8) & empty_squares.getData(): 
-    (pawnBoard.getData() >> 8) & empty_squares.getData();
-    BitBoard(empty_squares.getData()).printBitboard();
-    BitBoard(enemyPieces.getData()).printBitboard();
-
-    // Calculate double moves
-    /*only let pawns move forward if:
-    - (after a single move) pawns are on row 3 for white, row 6 for black
-    - after a single move, the next square is empty
-    */
-    BitBoard doubleMoves = color == WHITE ? 
-    ((singleMoves.getData() & Row3) << 8) & empty_squares.getData(): 
-    ((singleMoves.getData() & Row6) >> 8) & empty_squares.getData();
-
-    // Calculate left & right capturing
-    // can only capture when an enemy piece is present
-    // check left column. Ignore for pawns on column 1
-    BitBoard captureLeft = color == WHITE ? 
-    ((pawnBoard.getData() & NotCol1) << 7) & enemyPieces.getData():
-    ((pawnBoard.getData() & NotCol1) >> 9) & enemyPieces.getData();
-    // check right column. Ignore for pawns on column 8
-    BitBoard captureRight = color == WHITE ? 
-    ((pawnBoard.getData() & NotCol8) << 9) & enemyPieces.getData(): 
-    ((pawnBoard.getData() & NotCol8) >> 7) & enemyPieces.getData();
-
-    int shiftForward = (color == WHITE) ? 8 : -8;
-    int doubleShift = (color == WHITE) ? 16 : -16;
-    int captureLeftShift = (color == WHITE) ? 7 : -9;
-    int captureRightShift = (color == WHITE) ? 9 : -7;
-
-    // add single moves to list
-    addPawnBitBoardMoves(moves, singleMoves, shiftForward);
-    // add double moves to list
-    addPawnBitBoardMoves(moves, doubleMoves, doubleShift);
-    // add left captures to list
-    addPawnBitBoardMoves(moves, captureLeft, captureLeftShift);
-    // add right captures to list
-    addPawnBitBoardMoves(moves, captureRight, captureRightShift);
+    _position.makeMove(BitMove((uint16_t)move));
+    syncBitsFromPosition();
+    endTurn();
 }
 
-void Chess::addPawnBitBoardMoves(std::vector<BitMove>& moves, const BitBoard pawnMove, const int shift) {
-    if (pawnMove.getData() == 0) {
-        std::cout<<"grrr"<<std::endl;
-        return;
-    }
-    BitBoard new_board(pawnMove);
-    new_board.printBitboard();
-    pawnMove.forEachBit([&](int toSquare) {
-        int fromSquare = toSquare - shift;
-        moves.emplace_back(fromSquare, toSquare, Pawn);
-    });
-}
+#pragma region Chess Piece Movement
 
-#pragma endregion
+MoveList Chess::generateAllMoves()
+{
+    MoveList moves;
+    _position.generateAllMoves(moves);
+    return moves;
+}
 
 #pragma endregion
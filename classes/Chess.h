@@ -2,9 +2,12 @@
 
 #include "Game.h"
 #include "Grid.h"
-#include "BitBoard.h"
+#include "Position.h"
+#include "Search.h"
 
 constexpr int pieceSize = 80;
+// transposition table the AI searches with, in megabytes
+constexpr size_t ChessHashMegabytes = 64;
 
 //template <typename TYPE> void plusPlus(TYPE) {TYPE++;}
 
@@ -19,6 +22,7 @@ public:
     bool canBitMoveFrom(Bit &bit, BitHolder &src) override;
     bool canBitMoveFromTo(Bit &bit, BitHolder &src, BitHolder &dst) override;
     bool actionForEmptyHolder(BitHolder &holder) override;
+    void bitMovedFromTo(Bit &bit, BitHolder &src, BitHolder &dst) override;
 
     void stopGame() override;
 
@@ -29,6 +33,13 @@ public:
     std::string stateString() override;
     void setStateString(const std::string &s) override;
 
+    void updateAI() override;
+    bool gameHasAI() override { return true; }
+    bool hasBackgroundAI() override { return true; }
+    void prepareAI() override;
+    int thinkAI() override;
+    void applyAIMove(int move) override;
+    void cancelAI() override { _search.stop(); }
     Grid* getGrid() override { return _grid; }
 
 private:
@@ -37,38 +48,19 @@ private:
     void FENtoBoard(const std::string& fen);
     char pieceNotation(int x, int y) const;
 
-    #define WHITE 1
-    #define BLACK -1
-
-    // piece movement
-    // Knight
-    BitBoard generateKnightMoveBitBoard(int square); 
-    void generateKnightMoves(std::vector<BitMove>& moves, BitBoard knightBoard, uint64_t empty_squares);
-    
-    BitBoard  _knightBitBoards[64];
-    std::pair<int, int> knightOffsets[8] = {  // all possible moveable positions as a knight
-        {2, 1}, {2, -1}, {-2, 1}, {-2, -1},
-        {1, 2}, {1, -2}, {-1, 2}, {-1, -2}
-    };
-    
-
-    //King
-    // Only accounts for the position of ONE KING, whose index pos is indicated at kingPos
-    BitBoard  _kingBitBoards[64];
-    BitBoard generateKingMoveBitBoard(int square); 
-    void generateKingMoves(std::vector<BitMove>& moves, unsigned int kingPos, uint64_t empty_squares);
-    std::pair<int, int> kingOffsets[8] = {  // all possible moveable positions as a knight
-        {1, 0}, {1, 1}, {0, 1}, {-1, 1},
-        {-1, 0}, {-1, -1}, {0, -1}, {1, -1}
-    };
-
-    // Pawn
-    BitBoard  _pawnBitBoards[64];
-    void generatePawnMoves(std::vector<BitMove>& moves, BitBoard pawnBoard, BitBoard empty_squares, BitBoard enemyPieces, char color);
-    void addPawnBitBoardMoves(std::vector<BitMove>& moves, const BitBoard pawnMove, const int shift);
+    // make the sprites match _position
+    void syncBitsFromPosition();
 
     Grid* _grid;
-    std::vector<BitMove> generateAllMoves();
-
-    std::vector<BitMove>    _moves;
+    MoveList generateAllMoves();
+
+    MoveList                _moves;
+    Position                _position;
+    Search                  _search;
+    // the copy of _position the AI thread searches, and how long it has
+    Position                _aiPosition;
+    SearchLimits            _aiLimits;
+    // what's left on the AI's clock, and when it started on this move
+    int64_t                 _aiClock;
+    std::chrono::steady_clock::time_point _aiThinkStart;
 };
\ No newline at end of file
@@ -2,9 +2,7 @@
 
 #include "Game.h"
 #include "Grid.h"
-
-const int CONNECT4_COLS = 7;
-const int CONNECT4_ROWS = 6;
+#include "Connect4Rules.h"
 
 class Connect4 : public Game
 {
@@ -31,10 +29,6 @@ public:
 
 private:
     Bit* PieceForPlayer(const int playerNumber);
-    int getLowestEmptyRow(int col);
-    bool isColumnFull(int col);
-    Player* ownerAt(int x, int y) const;
-    bool checkDirection(int startX, int startY, int dx, int dy, Player* player);
 
     Grid* _grid;
 };
\ No newline at end of file
@@ -0,0 +1,65 @@
+#include "Connect4Rules.h"
+
+static char cellAt(const std::string& state, int x, int y)
+{
+    if (x < 0 || x >= CONNECT4_COLS || y < 0 || y >= CONNECT4_ROWS) {
+        return '0';
+    }
+    return state[y * CONNECT4_COLS + x];
+}
+
+int connect4LowestEmptyRow(const std::string& state, int col)
+{
+    for (int row = CONNECT4_ROWS - 1; row >= 0; row--) {
+        if (cellAt(state, col, row) == '0') {
+            return row;
+        }
+    }
+    return -1;
+}
+
+bool connect4IsColumnFull(const std::string& state, int col)
+{
+    return cellAt(state, col, 0) != '0';
+}
+
+bool connect4IsBoardFull(const std::string& state)
+{
+    for (int x = 0; x < CONNECT4_COLS; x++) {
+        if (!connect4IsColumnFull(state, x)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Searches in a specific direction (dx, dy) from a starting point (startX, startY)
+// to check if there are 4 consecutive pieces belonging to the same player.
+static bool checkDirection(const std::string& state, int startX, int startY, int dx, int dy, char piece)
+{
+    for (int i = 0; i < 4; i++) {
+        if (cellAt(state, startX + i * dx, startY + i * dy) != piece) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Checks for a Connect 4 winner by examining all possible 4-in-a-row combinations:
+// horizontal, vertical, and both diagonal directions.
+int connect4Winner(const std::string& state)
+{
+    for (int y = 0; y < CONNECT4_ROWS; y++) {
+        for (int x = 0; x < CONNECT4_COLS; x++) {
+            char piece = cellAt(state, x, y);
+            if (piece == '0') {
+                continue;
+            }
+            if (checkDirection(state, x, y, 1, 0, piece) || checkDirection(state, x, y, 0, 1, piece) ||
+                checkDirection(state, x, y, 1, 1, piece) || checkDirection(state, x, y, -1, 1, piece)) {
+                return piece - '1';
+            }
+        }
+    }
+    return -1;
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "GameRules.h"
+#include <string>
+
+//
+// connect 4 rules on the state string alone, no sprites or textures
+// the state is 42 characters, row by row from the top: '0' empty, '1' for the first player, '2' for the second
+//
+const int CONNECT4_COLS = 7;
+const int CONNECT4_ROWS = 6;
+
+// the row a piece dropped in col lands on, -1 if the column is full
+int connect4LowestEmptyRow(const std::string& state, int col);
+
+bool connect4IsColumnFull(const std::string& state, int col);
+
+// true when every column is full
+bool connect4IsBoardFull(const std::string& state);
+
+// the player number (0 or 1) with four in a row, -1 if nobody has one yet
+int connect4Winner(const std::string& state);
@@ -0,0 +1,32 @@
+#include "Evaluation.h"
+#include "Material.h"
+#include <algorithm>
+
+constexpr uint64_t LightSquares(0x55AA55AA55AA55AAULL);
+
+// bishops on opposite colours can't contest each other's squares, so extra pawns often don't win
+static const int OppositeBishopsScale = 32;
+
+int evaluate(const Position& position, PawnTable& pawns)
+{
+    // kept well clear of mate scores whatever the network says
+    if (!position.accumulators.empty()) {
+        return std::clamp(nnueEvaluate(position.accumulators.back(), position.sideToMove), -20000, 20000);
+    }
+    MaterialEntry material = probeMaterial(position.materialKey);
+    if (material.flags & InsufficientMaterial) {
+        return 0;
+    }
+    const PawnEntry& pawnEntry = pawns.probe(position);
+    int midgame = position.midgameScore + material.midgame + pawnEntry.midgame;
+    int endgame = position.endgameScore + material.endgame + pawnEntry.endgame;
+    int score = (midgame * material.phase + endgame * (MaxPhase - material.phase)) / MaxPhase;
+
+    int scale = material.scale[score > 0 ? White : Black];
+    if ((material.flags & BishopEnding)
+        && !(position.pieces[White][Bishop] & LightSquares) != !(position.pieces[Black][Bishop] & LightSquares)) {
+        scale = std::min(scale, OppositeBishopsScale);
+    }
+    score = score * scale / ScaleNormal;
+    return position.sideToMove == White ? score : -score;
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "PawnTable.h"
+#include "Position.h"
+
+//
+// static evaluation of a chess position, in centipawns from the side to move's point of view
+// the middlegame and endgame piece-square totals the position keeps are blended by the phase,
+// so pieces drift from their middlegame squares to their endgame ones as material comes off.
+// pawn structure comes from the caller's pawn table, which only has to work it out for new structures,
+// and the phase, imbalance and drawish endings from the material table (see Material.h).
+// when a network has been loaded (see Nnue.h) positions set up after that are evaluated by it instead
+//
+int evaluate(const Position& position, PawnTable& pawns);
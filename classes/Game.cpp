@@ -15,6 +15,8 @@ Game::Game()
 	_gameOptions.rowY = 0;
 	_gameOptions.score = 0;
 	_gameOptions.AIDepthSearches = 0;
+	_gameOptions.AITimeControl = 0;
+	_gameOptions.AIIncrement = 0;
 	_gameOptions.AIvsAI = false;
 
 	_table = nullptr;
@@ -112,6 +114,12 @@ void Game::scanForMouse()
 	{
 		return;
 	}
+	// the board isn't the player's while a search runs on it, even on their turn in AI vs AI
+	if (isAIThinking())
+	{
+		cancelDrag();
+		return;
+	}
 #if defined(UCI_INTERFACE)
 	return;
 #endif
@@ -246,8 +254,45 @@ void Game::updateAI()
 {
 }
 
+void Game::pollAI()
+{
+	if (!hasBackgroundAI())
+	{
+		updateAI();
+		return;
+	}
+	if (!_aiFuture.valid())
+	{
+		prepareAI();
+		_aiFuture = std::async(std::launch::async, [this]() { return thinkAI(); });
+		return;
+	}
+	if (_aiFuture.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+	{
+		applyAIMove(_aiFuture.get());
+	}
+}
+
+void Game::stopAI()
+{
+	if (!_aiFuture.valid())
+	{
+		return;
+	}
+	// keep asking, in case the worker hadn't started searching yet when the first request went in
+	do
+	{
+		cancelAI();
+	} while (_aiFuture.wait_for(std::chrono::milliseconds(1)) != std::future_status::ready);
+	_aiFuture.get();
+}
+
 void Game::mouseDown(ImVec2 &location, Entity *entity)
 {
+	if (isAIThinking())
+	{
+		return;
+	}
 	bool placing = false;
 	_dragStartPos = location;
 	if (entity && entity->getEntityType() == Entity::EntityBit)
@@ -335,7 +380,7 @@ void Game::mouseUp(ImVec2 &location, Entity *entity)
 	if (!_dragBit)
 	{
 		// If no bit was clicked, see if it's a BitHolder the game will let the user add a Bit to:
-		if (entity && entity->getEntityType() == Entity::EntityBitHolder)
+		if (entity && entity->getEntityType() == Entity::EntityBitHolder && !isAIThinking())
 		{
 			BitHolder *holder = (BitHolder *)entity;
 			if (actionForEmptyHolder(*holder))
@@ -397,6 +442,30 @@ void Game::mouseUp(ImVec2 &location, Entity *entity)
 	}
 }
 
+//
+// put a picked up bit back where it came from, as if it had been dropped nowhere
+//
+void Game::cancelDrag()
+{
+	if (!_dragBit)
+	{
+		return;
+	}
+	if (_dropTarget)
+	{
+		_dropTarget->willNotDropBit(_dragBit);
+		_dropTarget->setHighlighted(false);
+	}
+	_dragBit->setPickedUp(false);
+	if (_oldHolder)
+		_oldHolder->cancelDragBit(_dragBit);
+	_dragBit->moveTo(_oldPos);
+	clearBoardHighlights();
+	_dropTarget = nullptr;
+	_dragBit = nullptr;
+	_oldHolder = nullptr;
+}
+
 void Game::clearBoardHighlights()
 {
 }
\ No newline at end of file
@@ -22,10 +22,7 @@
 #include "Bit.h"
 #include "BitHolder.h"
 #include "Grid.h"
-
-
-const int AI_PLAYER = 1;
-const int HUMAN_PLAYER = -1;
+#include "GameRules.h"
 
 class GameTable;
 
@@ -41,6 +38,9 @@ struct GameOptions
 	int score;
 	int AIDepthSearches;
 	int AIMAXDepth;
+	// the AI's clock in milliseconds, 0 to search to AIMAXDepth instead
+	int AITimeControl;
+	int AIIncrement;
 	bool AIvsAI;
 };
 
@@ -95,6 +95,24 @@ public:
 	virtual void stopGame() = 0;
 	virtual bool gameHasAI();
 	virtual void updateAI();
+
+	//
+	// AI that thinks on a worker thread so the window keeps drawing
+	// prepareAI copies whatever the search needs on the UI thread, thinkAI runs on the worker and may only
+	// touch that copy, and applyAIMove plays its answer back on the UI thread. cancelAI asks a running
+	// thinkAI to return early, from any thread. games that don't split their AI up keep running updateAI inline
+	//
+	virtual bool hasBackgroundAI() { return false; }
+	virtual void prepareAI() {}
+	virtual int thinkAI() { return -1; }
+	virtual void applyAIMove(int move) {}
+	virtual void cancelAI() {}
+
+	// called every frame while it's the AI's turn: starts thinking, or plays the move once it's ready
+	void pollAI();
+	bool isAIThinking() const { return _aiFuture.valid(); }
+	// cancel any thinking and wait for the worker to finish, dropping its move
+	void stopAI();
 	virtual void pieceTaken(Bit *bit){};
 
 	virtual std::string initialStateString() = 0;
@@ -142,6 +160,7 @@ protected:
 	void mouseMoved(ImVec2 &location, Entity *bit);
 	void mouseUp(ImVec2 &location, Entity *bit);
 	void findDropTarget(ImVec2 &pos);
+	void cancelDrag();
 
 	ImVec2 _dragStartPos;
 	ImVec2 _dragOffset;
@@ -151,4 +170,7 @@ protected:
 	BitHolder *_dropTarget;
 	BitHolder *_oldHolder;
 	bool _dragMoved;
+
+	// the worker running thinkAI, valid from the frame it starts until its move is applied
+	std::future<int> _aiFuture;
 };
@@ -0,0 +1,11 @@
+#pragma once
+
+//
+// shared by the headless rules of every game and by the game classes that draw them
+// the rules work on the same state strings the games print, one character per square, so they need
+// no sprites, textures or window
+//
+
+// the AI's player number, and the sign the tic tac toe negamax gives the human
+const int AI_PLAYER = 1;
+const int HUMAN_PLAYER = -1;
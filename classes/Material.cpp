@@ -0,0 +1,129 @@
+#include "Material.h"
+#include <algorithm>
+#include <vector>
+
+// largest count of each piece the table covers, the starting numbers
+static const int TableLimits[7] = { 0, 8, 2, 2, 2, 1, 1 };
+// signatures per side: 9 pawn counts x 3 x 3 x 3 x 2
+static const int SideSignatures = 9 * 3 * 3 * 3 * 2;
+
+static const int BishopPairBonus[2] = { 30, 50 };
+// knights get better and rooks worse the more pawns there are, per pawn away from five
+static const int KnightPawnAdjust = 6;
+static const int RookPawnAdjust = 12;
+
+static const int pieceValues[7] = { 0, 100, 320, 330, 500, 900, 0 };
+
+constexpr uint64_t LightSquares(0x55AA55AA55AA55AAULL);
+
+static int countOf(uint64_t materialKey, int color, int piece)
+{
+    return (int)((materialKey >> materialKeyShift(color, piece)) & 15);
+}
+
+static MaterialEntry computeMaterial(const int counts[2][7])
+{
+    MaterialEntry entry = {};
+    int phase = 0;
+    int nonPawn[2] = { 0, 0 };
+    for (int color = White; color <= Black; color++) {
+        for (int piece = Knight; piece < King; piece++) {
+            phase += PhaseWeights[piece] * counts[color][piece];
+            nonPawn[color] += pieceValues[piece] * counts[color][piece];
+        }
+    }
+    entry.phase = (uint8_t)std::min(phase, MaxPhase);
+
+    for (int us = White; us <= Black; us++) {
+        int them = us ^ 1;
+        int sign = us == White ? 1 : -1;
+        int pawnsAboveFive = counts[us][Pawn] - 5;
+        int imbalance = KnightPawnAdjust * pawnsAboveFive * counts[us][Knight]
+                      - RookPawnAdjust * pawnsAboveFive * counts[us][Rook];
+        bool bishopPair = counts[us][Bishop] >= 2;
+        entry.midgame += (int16_t)(sign * (imbalance + (bishopPair ? BishopPairBonus[0] : 0)));
+        entry.endgame += (int16_t)(sign * (imbalance + (bishopPair ? BishopPairBonus[1] : 0)));
+
+        // without pawns, being up no more than a minor piece rarely wins, and two knights can't force mate
+        int scale = ScaleNormal;
+        if (counts[us][Pawn] == 0) {
+            bool twoKnights = counts[us][Knight] == 2 && nonPawn[us] == 2 * pieceValues[Knight] && nonPawn[them] == 0;
+            if (nonPawn[us] - nonPawn[them] <= pieceValues[Bishop] || twoKnights) {
+                scale = nonPawn[us] < pieceValues[Rook] || twoKnights ? 0 : 16;
+            }
+        }
+        entry.scale[us] = (uint8_t)scale;
+    }
+
+    int pawns = counts[White][Pawn] + counts[Black][Pawn];
+    int knights = counts[White][Knight] + counts[Black][Knight];
+    int bishops = counts[White][Bishop] + counts[Black][Bishop];
+    int majors = counts[White][Rook] + counts[Black][Rook] + counts[White][Queen] + counts[Black][Queen];
+    if (pawns == 0 && majors == 0 && knights + bishops <= 1) {
+        entry.flags |= InsufficientMaterial;
+    } else if (pawns == 0 && majors == 0 && knights == 0) {
+        entry.flags |= OnlyBishops;
+    }
+    if (pawns && majors + knights == 0 && counts[White][Bishop] == 1 && counts[Black][Bishop] == 1) {
+        entry.flags |= BishopEnding;
+    }
+    return entry;
+}
+
+static int sideIndex(const int counts[7])
+{
+    return (((counts[Pawn] * 3 + counts[Knight]) * 3 + counts[Bishop]) * 3 + counts[Rook]) * 2 + counts[Queen];
+}
+
+static std::vector<MaterialEntry> buildMaterialTable()
+{
+    std::vector<MaterialEntry> table(SideSignatures * SideSignatures);
+    int counts[2][7] = {};
+    // every combination for white, and inside that every one for black
+    for (int white = 0; white < SideSignatures; white++) {
+        for (int black = 0; black < SideSignatures; black++) {
+            int side[2] = { white, black };
+            for (int color = White; color <= Black; color++) {
+                int rest = side[color];
+                counts[color][Queen] = rest % 2; rest /= 2;
+                counts[color][Rook] = rest % 3; rest /= 3;
+                counts[color][Bishop] = rest % 3; rest /= 3;
+                counts[color][Knight] = rest % 3; rest /= 3;
+                counts[color][Pawn] = rest;
+            }
+            table[white * SideSignatures + black] = computeMaterial(counts);
+        }
+    }
+    return table;
+}
+
+MaterialEntry probeMaterial(uint64_t materialKey)
+{
+    static const std::vector<MaterialEntry> table = buildMaterialTable();
+
+    int counts[2][7] = {};
+    bool inTable = true;
+    for (int color = White; color <= Black; color++) {
+        for (int piece = Pawn; piece < King; piece++) {
+            counts[color][piece] = countOf(materialKey, color, piece);
+            inTable &= counts[color][piece] <= TableLimits[piece];
+        }
+    }
+    if (!inTable) {
+        return computeMaterial(counts);
+    }
+    return table[sideIndex(counts[White]) * SideSignatures + sideIndex(counts[Black])];
+}
+
+bool isInsufficientMaterial(const Position& position)
+{
+    MaterialEntry entry = probeMaterial(position.materialKey);
+    if (entry.flags & InsufficientMaterial) {
+        return true;
+    }
+    if (entry.flags & OnlyBishops) {
+        uint64_t bishops = position.pieces[White][Bishop] | position.pieces[Black][Bishop];
+        return (bishops & LightSquares) == 0 || (bishops & ~LightSquares) == 0;
+    }
+    return false;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "Position.h"
+
+//
+// what the piece counts alone say about a position
+// the position keeps its counts packed into materialKey, and every ordinary signature (no more than
+// the starting number of any piece) is worked out once at startup into a table indexed straight off
+// them. the odd signature promotions create past that is worked out when it turns up
+//
+enum MaterialFlags : uint8_t
+{
+    InsufficientMaterial = 1,       // no sequence of moves can mate: bare kings, or a lone minor piece
+    OnlyBishops          = 2,       // kings and bishops only, a dead draw if every bishop is on one colour
+    BishopEnding         = 4,       // one bishop each plus pawns, drawish if the bishops are on opposite colours
+};
+
+// evaluations get multiplied by scale / ScaleNormal
+constexpr int ScaleNormal = 64;
+
+struct MaterialEntry
+{
+    int16_t     midgame;            // imbalance terms, white minus black
+    int16_t     endgame;
+    uint8_t     phase;              // 0 for bare kings up to MaxPhase for a full set
+    uint8_t     scale[2];           // [ChessColor], applied when that side is the one ahead
+    uint8_t     flags;              // MaterialFlags
+};
+
+MaterialEntry probeMaterial(uint64_t materialKey);
+
+// neither side can ever mate, counting bishops that all stand on the same colour
+bool isInsufficientMaterial(const Position& position);
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "Bitboard.h"
+
+// no legal chess position has more than 218 moves
+constexpr int MaxMoves = 256;
+
+//
+// fixed capacity move list that lives on the stack, so generating moves never touches the heap.
+// every move has a score slot beside it for move ordering; the scores sit in their own array so
+// range-for and indexing still hand back plain moves
+//
+class MoveList
+{
+public:
+    MoveList() : _size(0) { }
+
+    void emplace_back(int from, int to, int flags = QuietMove) {
+        _moves[_size++] = BitMove(from, to, flags);
+    }
+    void push_back(BitMove move) { _moves[_size++] = move; }
+    void clear() { _size = 0; }
+
+    int size() const { return _size; }
+    bool empty() const { return _size == 0; }
+
+    BitMove& operator[](int index) { return _moves[index]; }
+    const BitMove& operator[](int index) const { return _moves[index]; }
+    int& score(int index) { return _scores[index]; }
+    int score(int index) const { return _scores[index]; }
+
+    BitMove* begin() { return _moves; }
+    BitMove* end() { return _moves + _size; }
+    const BitMove* begin() const { return _moves; }
+    const BitMove* end() const { return _moves + _size; }
+
+    bool contains(BitMove move) const {
+        for (int i = 0; i < _size; i++) {
+            if (_moves[i] == move) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    BitMove     _moves[MaxMoves];
+    int         _scores[MaxMoves];
+    int         _size;
+};
@@ -0,0 +1,183 @@
+#include "MovePicker.h"
+#include <cstring>
+#include <cstdlib>
+
+void MoveHistory::clear()
+{
+    memset(killers, 0, sizeof(killers));
+    memset(counterMoves, 0, sizeof(counterMoves));
+    memset(butterfly, 0, sizeof(butterfly));
+}
+
+void MoveHistory::addBonus(int& entry, int bonus)
+{
+    entry += bonus - entry * abs(bonus) / HistoryMax;
+}
+
+template <SliderBackend Backend>
+MovePicker<Backend>::MovePicker(const Position& position, BitMove ttMove, const BitMove* killers, BitMove counterMove,
+                                const int (*history)[64])
+    : _position(position), _ttMove(ttMove), _counterMove(counterMove), _history(history)
+{
+    _killers[0] = killers[0];
+    _killers[1] = killers[1];
+    _perturbSeed = 0;
+    _capturesOnly = false;
+    _stage = HashMove;
+    _current = 0;
+    _badCount = 0;
+}
+
+template <SliderBackend Backend>
+MovePicker<Backend>::MovePicker(const Position& position)
+    : _position(position), _ttMove(), _counterMove(), _history(nullptr)
+{
+    _killers[0] = BitMove{};
+    _killers[1] = BitMove{};
+    _perturbSeed = 0;
+    _capturesOnly = true;
+    _stage = GenerateCaptures;
+    _current = 0;
+    _badCount = 0;
+}
+
+template <SliderBackend Backend>
+BitMove MovePicker<Backend>::pickBest()
+{
+    // selection sort one step at a time
+    int best = _current;
+    for (int i = _current + 1; i < _moves.size(); i++) {
+        if (_moves.score(i) > _moves.score(best)) {
+            best = i;
+        }
+    }
+    std::swap(_moves[_current], _moves[best]);
+    std::swap(_moves.score(_current), _moves.score(best));
+    return _moves[_current++];
+}
+
+// underpromotions, and captures that lose material once the exchange is played out
+template <SliderBackend Backend>
+bool MovePicker<Backend>::isBadCapture(BitMove move) const
+{
+    if (move.isPromotion() && move.promotionPiece() != Queen) {
+        return true;
+    }
+    return !_position.see<Backend>(move, 0);
+}
+
+template <SliderBackend Backend>
+bool MovePicker<Backend>::isSpecial(BitMove move) const
+{
+    return move == _ttMove || move == _killers[0] || move == _killers[1] || move == _counterMove;
+}
+
+template <SliderBackend Backend>
+BitMove MovePicker<Backend>::nextMove()
+{
+    switch (_stage) {
+    case HashMove:
+        _stage = GenerateCaptures;
+        if (!_ttMove.isNone() && _position.isLegal<Backend>(_ttMove)) {
+            return _ttMove;
+        }
+        _ttMove = BitMove{};
+        [[fallthrough]];
+
+    case GenerateCaptures:
+        _position.generateCaptures<Backend>(_moves);
+        for (int i = 0; i < _moves.size(); i++) {
+            BitMove move = _moves[i];
+            // most valuable victim first, and of those the least valuable attacker
+            int victim = move.flags() == EnPassantCapture ? Pawn : tagPiece(_position.board[move.to()]);
+            _moves.score(i) = SeeValues[victim] * 8 - _position.movedPiece(move)
+                            + (move.isPromotion() ? SeeValues[move.promotionPiece()] : 0);
+        }
+        _stage = GoodCaptures;
+        [[fallthrough]];
+
+    case GoodCaptures:
+        while (_current < _moves.size()) {
+            BitMove move = pickBest();
+            if (move == _ttMove) {
+                continue;
+            }
+            if (isBadCapture(move)) {
+                _moves[_badCount++] = move;
+                continue;
+            }
+            return move;
+        }
+        if (_capturesOnly) {
+            _stage = Done;
+            break;
+        }
+        _stage = FirstKiller;
+        [[fallthrough]];
+
+    // killers and the countermove are always quiet, anything that's become a capture fails isLegal
+    case FirstKiller:
+        _stage = SecondKiller;
+        if (!_killers[0].isNone() && _killers[0] != _ttMove && _position.isLegal<Backend>(_killers[0])) {
+            return _killers[0];
+        }
+        [[fallthrough]];
+
+    case SecondKiller:
+        _stage = CounterMove;
+        if (!_killers[1].isNone() && _killers[1] != _ttMove && _killers[1] != _killers[0]
+            && _position.isLegal<Backend>(_killers[1])) {
+            return _killers[1];
+        }
+        [[fallthrough]];
+
+    case CounterMove:
+        _stage = GenerateQuiets;
+        if (!_counterMove.isNone() && _counterMove != _ttMove && _counterMove != _killers[0]
+            && _counterMove != _killers[1] && _position.isLegal<Backend>(_counterMove)) {
+            return _counterMove;
+        }
+        [[fallthrough]];
+
+    case GenerateQuiets:
+        // quiets go after the captures, which have all been handed out or parked by now
+        _current = _moves.size();
+        _position.generateQuiets<Backend>(_moves);
+        for (int i = _current; i < _moves.size(); i++) {
+            BitMove move = _moves[i];
+            int score = _history[move.from()][move.to()];
+            if (_perturbSeed) {
+                score += (int)((move.raw() * 2654435761u + _perturbSeed * 40503u) >> 22);
+            }
+            _moves.score(i) = score;
+        }
+        _stage = Quiets;
+        [[fallthrough]];
+
+    case Quiets:
+        while (_current < _moves.size()) {
+            BitMove move = pickBest();
+            if (!isSpecial(move)) {
+                return move;
+            }
+        }
+        _current = 0;
+        _stage = BadCaptures;
+        [[fallthrough]];
+
+    case BadCaptures:
+        // already in the order they were picked
+        if (_current < _badCount) {
+            return _moves[_current++];
+        }
+        _stage = Done;
+        [[fallthrough]];
+
+    case Done:
+        break;
+    }
+    return BitMove{};
+}
+
+template class MovePicker<SliderMagic>;
+template class MovePicker<SliderPext>;
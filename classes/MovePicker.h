@@ -0,0 +1,87 @@
+#pragma once
+
+#include "Position.h"
+
+// deepest the search can go from the root
+constexpr int MaxPly = 128;
+
+//
+// the quiet move tables a search thread learns as it goes
+// - killers: two quiet moves per ply that caused a cutoff in a sibling node
+// - countermoves: the quiet reply that refuted the opponent's last move, by its piece and square
+// - history: how often each quiet from/to pair has caused a cutoff, per side, kept in +-HistoryMax
+//
+constexpr int HistoryMax = 16384;
+
+struct MoveHistory
+{
+    BitMove     killers[MaxPly][2];
+    BitMove     counterMoves[2][7][64];    // [color][piece][to] of the move being answered
+    int         butterfly[2][64][64];      // [color][from][to]
+
+    void        clear();
+    // nudge a history entry towards +-HistoryMax, taking less off the closer it already is
+    static void addBonus(int& entry, int bonus);
+};
+
+//
+// hands out moves best first, generating them in stages so a cutoff early on never pays for the rest:
+// - the hash move, checked for legality rather than generated
+// - captures and promotions by most valuable victim and least valuable attacker, holding back the
+//   ones that look like they lose material
+// - the two killers and the countermove, again just checked for legality
+// - quiets by history
+// - the captures held back earlier
+// each call picks the best of what's left in its stage, so the moves after a cutoff are never sorted.
+// the quiescence search only wants the first lot of captures, and none of the rest.
+// templated on the slider backend the search is running with
+//
+template <SliderBackend Backend>
+class MovePicker
+{
+public:
+    MovePicker(const Position& position, BitMove ttMove, const BitMove* killers, BitMove counterMove,
+               const int (*history)[64]);
+    // the captures that don't lose material, for the quiescence search
+    explicit MovePicker(const Position& position);
+
+    // the next move to try, BitMove{} when there are none left
+    BitMove     nextMove();
+    // jiggle the order of the plain quiet moves by seed, for lazy SMP helpers
+    void        perturbQuiets(int seed) { _perturbSeed = seed; }
+
+private:
+    enum Stage
+    {
+        HashMove,
+        GenerateCaptures,
+        GoodCaptures,
+        FirstKiller,
+        SecondKiller,
+        CounterMove,
+        GenerateQuiets,
+        Quiets,
+        BadCaptures,
+        Done
+    };
+
+    // move the best scored move in [_current, end of list) to _current and return it
+    BitMove     pickBest();
+    bool        isBadCapture(BitMove move) const;
+    // already handed out by one of the single move stages
+    bool        isSpecial(BitMove move) const;
+
+    const Position& _position;
+    BitMove     _ttMove;
+    BitMove     _killers[2];
+    BitMove     _counterMove;
+    const int   (*_history)[64];
+    int         _perturbSeed;
+    bool        _capturesOnly;
+
+    Stage       _stage;
+    MoveList    _moves;
+    int         _current;
+    // bad captures get parked at the front of the list, in slots the good ones were already taken from
+    int         _badCount;
+};
@@ -0,0 +1,367 @@
+#include "Nnue.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h>
+#define NNUE_X86
+#if defined(_MSC_VER)
+#include <intrin.h>
+// msvc emits any intrinsic it's asked for, so the kernels need no per function target
+#define NNUE_TARGET(isa)
+#else
+#define NNUE_TARGET(isa) __attribute__((target(isa)))
+#endif
+#endif
+
+NnueBackend NnueBackendInUse = NnueScalar;
+
+static NnueNetwork _network;
+static bool _networkLoaded = false;
+static const void* _mapping = nullptr;
+static size_t _mappingSize = 0;
+
+// the dot product of a layer: output[o] = biases[o] + weights[o] . input, input a multiple of 32 long
+typedef void (*AffineKernel)(const uint8_t* input, int inputSize, const int8_t* weights, const int32_t* biases,
+                             int32_t* output, int outputSize);
+// add or take away one weight column across half the accumulator
+typedef void (*ColumnKernel)(int16_t* half, const int16_t* column);
+
+#pragma region Kernels
+
+static void affineScalar(const uint8_t* input, int inputSize, const int8_t* weights, const int32_t* biases,
+                         int32_t* output, int outputSize)
+{
+    for (int o = 0; o < outputSize; o++) {
+        const int8_t* row = weights + o * inputSize;
+        int32_t sum = biases[o];
+        for (int i = 0; i < inputSize; i++) {
+            sum += input[i] * row[i];
+        }
+        output[o] = sum;
+    }
+}
+
+static void addColumnScalar(int16_t* half, const int16_t* column)
+{
+    for (int i = 0; i < NnueHalfDimensions; i++) {
+        half[i] += column[i];
+    }
+}
+
+static void subColumnScalar(int16_t* half, const int16_t* column)
+{
+    for (int i = 0; i < NnueHalfDimensions; i++) {
+        half[i] -= column[i];
+    }
+}
+
+#if defined(NNUE_X86)
+// inputs are at most 127, so a pair of products summed by maddubs can't saturate
+NNUE_TARGET("sse4.1")
+static void affineSSE41(const uint8_t* input, int inputSize, const int8_t* weights, const int32_t* biases,
+                        int32_t* output, int outputSize)
+{
+    const __m128i ones = _mm_set1_epi16(1);
+    for (int o = 0; o < outputSize; o++) {
+        const int8_t* row = weights + o * inputSize;
+        __m128i sum = _mm_setzero_si128();
+        for (int i = 0; i < inputSize; i += 16) {
+            __m128i in = _mm_loadu_si128((const __m128i*)(input + i));
+            __m128i w = _mm_loadu_si128((const __m128i*)(row + i));
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_maddubs_epi16(in, w), ones));
+        }
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+        output[o] = biases[o] + _mm_cvtsi128_si32(sum);
+    }
+}
+
+NNUE_TARGET("sse4.1")
+static void addColumnSSE41(int16_t* half, const int16_t* column)
+{
+    for (int i = 0; i < NnueHalfDimensions; i += 8) {
+        __m128i* out = (__m128i*)(half + i);
+        _mm_storeu_si128(out, _mm_add_epi16(_mm_loadu_si128(out), _mm_loadu_si128((const __m128i*)(column + i))));
+    }
+}
+
+NNUE_TARGET("sse4.1")
+static void subColumnSSE41(int16_t* half, const int16_t* column)
+{
+    for (int i = 0; i < NnueHalfDimensions; i += 8) {
+        __m128i* out = (__m128i*)(half + i);
+        _mm_storeu_si128(out, _mm_sub_epi16(_mm_loadu_si128(out), _mm_loadu_si128((const __m128i*)(column + i))));
+    }
+}
+
+NNUE_TARGET("avx2")
+static void affineAVX2(const uint8_t* input, int inputSize, const int8_t* weights, const int32_t* biases,
+                       int32_t* output, int outputSize)
+{
+    const __m256i ones = _mm256_set1_epi16(1);
+    for (int o = 0; o < outputSize; o++) {
+        const int8_t* row = weights + o * inputSize;
+        __m256i sum = _mm256_setzero_si256();
+        for (int i = 0; i < inputSize; i += 32) {
+            __m256i in = _mm256_loadu_si256((const __m256i*)(input + i));
+            __m256i w = _mm256_loadu_si256((const __m256i*)(row + i));
+            sum = _mm256_add_epi32(sum, _mm256_madd_epi16(_mm256_maddubs_epi16(in, w), ones));
+        }
+        __m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+        half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0x4E));
+        half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0xB1));
+        output[o] = biases[o] + _mm_cvtsi128_si32(half);
+    }
+}
+
+NNUE_TARGET("avx2")
+static void addColumnAVX2(int16_t* half, const int16_t* column)
+{
+    for (int i = 0; i < NnueHalfDimensions; i += 16) {
+        __m256i* out = (__m256i*)(half + i);
+        _mm256_storeu_si256(out, _mm256_add_epi16(_mm256_loadu_si256(out), _mm256_loadu_si256((const __m256i*)(column + i))));
+    }
+}
+
+NNUE_TARGET("avx2")
+static void subColumnAVX2(int16_t* half, const int16_t* column)
+{
+    for (int i = 0; i < NnueHalfDimensions; i += 16) {
+        __m256i* out = (__m256i*)(half + i);
+        _mm256_storeu_si256(out, _mm256_sub_epi16(_mm256_loadu_si256(out), _mm256_loadu_si256((const __m256i*)(column + i))));
+    }
+}
+#endif
+
+#pragma endregion
+
+static AffineKernel affine = affineScalar;
+static ColumnKernel addColumn = addColumnScalar;
+static ColumnKernel subColumn = subColumnScalar;
+
+// avx2 also needs the os to save the ymm registers, which __builtin_cpu_supports and the xgetbv check cover
+static bool cpuSupports(NnueBackend backend)
+{
+    if (backend == NnueScalar) {
+        return true;
+    }
+#if defined(NNUE_X86) && defined(_MSC_VER)
+    int regs[4];
+    __cpuid(regs, 1);
+    bool sse41 = (regs[2] >> 19) & 1;
+    bool avx = ((regs[2] >> 27) & 1) && ((regs[2] >> 28) & 1) && (_xgetbv(0) & 6) == 6;
+    __cpuidex(regs, 7, 0);
+    bool avx2 = avx && ((regs[1] >> 5) & 1);
+    return backend == NnueAVX2 ? avx2 : sse41;
+#elif defined(NNUE_X86)
+    __builtin_cpu_init();
+    return backend == NnueAVX2 ? __builtin_cpu_supports("avx2") : __builtin_cpu_supports("sse4.1");
+#else
+    return false;
+#endif
+}
+
+const char* nnueBackendName(NnueBackend backend)
+{
+    return backend == NnueAVX2 ? "avx2" : backend == NnueSSE41 ? "sse4.1" : "scalar";
+}
+
+void setNnueBackend(NnueBackend backend)
+{
+    while (!cpuSupports(backend)) {
+        std::cout << "nnue kernels: " << nnueBackendName(backend) << " requested but not supported by this cpu" << std::endl;
+        backend = (NnueBackend)(backend - 1);
+    }
+    NnueBackendInUse = backend;
+    affine = affineScalar;
+    addColumn = addColumnScalar;
+    subColumn = subColumnScalar;
+#if defined(NNUE_X86)
+    if (backend == NnueSSE41) {
+        affine = affineSSE41;
+        addColumn = addColumnSSE41;
+        subColumn = subColumnSSE41;
+    } else if (backend == NnueAVX2) {
+        affine = affineAVX2;
+        addColumn = addColumnAVX2;
+        subColumn = subColumnAVX2;
+    }
+#endif
+    std::cout << "nnue kernels: " << nnueBackendName(NnueBackendInUse) << std::endl;
+}
+
+void initNnueBackend()
+{
+    NnueBackend backend = cpuSupports(NnueAVX2) ? NnueAVX2 : cpuSupports(NnueSSE41) ? NnueSSE41 : NnueScalar;
+    const char* forced = std::getenv("CHESS_NNUE_SIMD");
+    if (forced && strcmp(forced, "scalar") == 0) {
+        backend = NnueScalar;
+    } else if (forced && strcmp(forced, "sse41") == 0) {
+        backend = NnueSSE41;
+    } else if (forced && strcmp(forced, "avx2") == 0) {
+        backend = NnueAVX2;
+    }
+    setNnueBackend(backend);
+}
+
+#pragma region Loading
+
+// read only mapping of the whole file, nullptr if it can't be opened
+static const void* mapFile(const char* path, size_t& size)
+{
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return nullptr;
+    }
+    LARGE_INTEGER fileSize;
+    HANDLE mapping = GetFileSizeEx(file, &fileSize) ? CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+    const void* data = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    // the view keeps the mapping alive on its own
+    if (mapping) {
+        CloseHandle(mapping);
+    }
+    CloseHandle(file);
+    size = data ? (size_t)fileSize.QuadPart : 0;
+    return data;
+#else
+    int file = open(path, O_RDONLY);
+    if (file < 0) {
+        return nullptr;
+    }
+    struct stat info;
+    void* data = MAP_FAILED;
+    if (fstat(file, &info) == 0 && info.st_size > 0) {
+        data = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_SHARED, file, 0);
+    }
+    close(file);
+    if (data == MAP_FAILED) {
+        return nullptr;
+    }
+    size = (size_t)info.st_size;
+    return data;
+#endif
+}
+
+static void unmapFile(const void* data, size_t size)
+{
+#if defined(_WIN32)
+    UnmapViewOfFile(data);
+#else
+    munmap((void*)data, size);
+#endif
+}
+
+bool loadNnue(const char* path)
+{
+    size_t size = 0;
+    const void* data = mapFile(path, size);
+    if (!data) {
+        std::cout << "nnue: can't open " << path << std::endl;
+        return false;
+    }
+
+    // walk the layout, every block starting on a 64 byte boundary so the kernels' loads stay within a line
+    const uint8_t* bytes = (const uint8_t*)data;
+    size_t offset = 64;
+    auto block = [&](size_t length) {
+        const uint8_t* at = bytes + offset;
+        offset = (offset + length + 63) & ~(size_t)63;
+        return at;
+    };
+    NnueNetwork network;
+    network.transformerBiases = (const int16_t*)block(NnueHalfDimensions * sizeof(int16_t));
+    network.transformerWeights = (const int16_t*)block((size_t)NnueInputs * NnueHalfDimensions * sizeof(int16_t));
+    network.hidden1Biases = (const int32_t*)block(NnueHidden1 * sizeof(int32_t));
+    network.hidden1Weights = (const int8_t*)block(NnueHidden1 * 2 * NnueHalfDimensions);
+    network.hidden2Biases = (const int32_t*)block(NnueHidden2 * sizeof(int32_t));
+    network.hidden2Weights = (const int8_t*)block(NnueHidden2 * NnueHidden1);
+    network.outputBias = (const int32_t*)block(sizeof(int32_t));
+    network.outputWeights = (const int8_t*)block(NnueHidden2);
+
+    const int32_t shape[4] = { NnueInputs, NnueHalfDimensions, NnueHidden1, NnueHidden2 };
+    if (size != offset || memcmp(bytes, "CHESSNN1", 8) != 0 || memcmp(bytes + 8, shape, sizeof(shape)) != 0) {
+        std::cout << "nnue: " << path << " isn't a network of the right shape" << std::endl;
+        unmapFile(data, size);
+        return false;
+    }
+
+    if (_mapping) {
+        unmapFile(_mapping, _mappingSize);
+    } else {
+        initNnueBackend();
+    }
+    _mapping = data;
+    _mappingSize = size;
+    _network = network;
+    _networkLoaded = true;
+    std::cout << "nnue: loaded " << path << std::endl;
+    return true;
+}
+
+const NnueNetwork* nnueNetwork()
+{
+    return _networkLoaded ? &_network : nullptr;
+}
+
+#pragma endregion
+
+void nnueResetHalf(int16_t* half)
+{
+    memcpy(half, _network.transformerBiases, NnueHalfDimensions * sizeof(int16_t));
+}
+
+void nnueAddFeature(int16_t* half, int feature)
+{
+    addColumn(half, _network.transformerWeights + (size_t)feature * NnueHalfDimensions);
+}
+
+void nnueSubFeature(int16_t* half, int feature)
+{
+    subColumn(half, _network.transformerWeights + (size_t)feature * NnueHalfDimensions);
+}
+
+// hidden sums carry 6 fractional bits; drop them and clip into the next layer's 0..127 range
+static void clippedRelu(const int32_t* input, uint8_t* output, int size)
+{
+    for (int i = 0; i < size; i++) {
+        output[i] = (uint8_t)std::clamp(input[i] >> 6, 0, 127);
+    }
+}
+
+int nnueEvaluate(const NnueAccumulator& accumulator, int sideToMove)
+{
+    alignas(64) uint8_t transformed[2 * NnueHalfDimensions];
+    alignas(64) int32_t sums1[NnueHidden1];
+    alignas(64) uint8_t hidden1[NnueHidden1];
+    alignas(64) int32_t sums2[NnueHidden2];
+    alignas(64) uint8_t hidden2[NnueHidden2];
+    int32_t output;
+
+    const int16_t* halves[2] = { accumulator.values[sideToMove], accumulator.values[sideToMove ^ 1] };
+    for (int side = 0; side < 2; side++) {
+        for (int i = 0; i < NnueHalfDimensions; i++) {
+            transformed[side * NnueHalfDimensions + i] = (uint8_t)std::clamp((int)halves[side][i], 0, 127);
+        }
+    }
+    affine(transformed, 2 * NnueHalfDimensions, _network.hidden1Weights, _network.hidden1Biases, sums1, NnueHidden1);
+    clippedRelu(sums1, hidden1, NnueHidden1);
+    affine(hidden1, NnueHidden1, _network.hidden2Weights, _network.hidden2Biases, sums2, NnueHidden2);
+    clippedRelu(sums2, hidden2, NnueHidden2);
+    affine(hidden2, NnueHidden2, _network.outputWeights, _network.outputBias, &output, 1);
+    // the output is trained 16 times larger than centipawns
+    return output / 16;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+
+//
+// efficiently updatable neural network evaluation
+// HalfKP inputs: for each side, every non-king piece on every square, bucketed by that side's own king
+// square. a position only ever has a few dozen of the 40960 inputs on, and a move only turns a couple
+// on or off, so the first layer's output (the accumulator) is kept up to date by adding and subtracting
+// weight columns as pieces move instead of being recomputed. only a king move starts its side over.
+//
+//   40960 -> 256 per side, int16 weights
+//   512 (side to move's half first) -> 32 -> 32 -> 1, int8 weights with int32 sums
+//
+// between layers values are clipped to 0..127 and stored as uint8, so the dot products run on
+// maddubs: 32 multiplies per avx2 instruction. the kernels are picked from cpuid at load time
+//
+constexpr int NnueInputs = 64 * 10 * 64;    // king square x (5 piece types x 2 colors) x square
+constexpr int NnueHalfDimensions = 256;
+constexpr int NnueHidden1 = 32;
+constexpr int NnueHidden2 = 32;
+
+// the accumulator for both sides, [ChessColor][neuron]
+struct alignas(64) NnueAccumulator
+{
+    int16_t     values[2][NnueHalfDimensions];
+};
+
+//
+// the network weights, pointing straight into the mapped file
+// file layout, each block starting on a 64 byte boundary:
+//   header: "CHESSNN1" then int32 NnueInputs, NnueHalfDimensions, NnueHidden1, NnueHidden2
+//   int16 transformer biases [256], int16 transformer weights [40960][256]
+//   int32 hidden1 biases [32], int8 hidden1 weights [32][512]
+//   int32 hidden2 biases [32], int8 hidden2 weights [32][32]
+//   int32 output bias [1], int8 output weights [32]
+//
+struct NnueNetwork
+{
+    const int16_t*  transformerBiases;
+    const int16_t*  transformerWeights;
+    const int32_t*  hidden1Biases;
+    const int8_t*   hidden1Weights;
+    const int32_t*  hidden2Biases;
+    const int8_t*   hidden2Weights;
+    const int32_t*  outputBias;
+    const int8_t*   outputWeights;
+};
+
+enum NnueBackend {
+    NnueScalar,
+    NnueSSE41,
+    NnueAVX2
+};
+
+extern NnueBackend NnueBackendInUse;
+
+// map a network file and evaluate with it from then on. false if it can't be read or has the wrong
+// shape, in which case whatever was loaded before stays. not safe while a search is running
+bool loadNnue(const char* path);
+// nullptr until a network has loaded
+const NnueNetwork* nnueNetwork();
+
+// picks the widest kernels cpuid allows, CHESS_NNUE_SIMD=scalar|sse41|avx2 in the environment overrides it
+void initNnueBackend();
+// force a backend, for benchmarking. asking for more than the cpu has falls back to what it does have
+void setNnueBackend(NnueBackend backend);
+const char* nnueBackendName(NnueBackend backend);
+
+// which input a piece turns on, seen from perspective. black sees the board flipped, so both sides share weights
+inline int nnueFeatureIndex(int perspective, int kingSquare, int color, int piece, int square)
+{
+    int flip = perspective == 0 ? 0 : 56;
+    return (((kingSquare ^ flip) * 5 + piece - 1) * 2 + (color != perspective)) * 64 + (square ^ flip);
+}
+
+// start a side's half of the accumulator over from the biases
+void nnueResetHalf(int16_t* half);
+void nnueAddFeature(int16_t* half, int feature);
+void nnueSubFeature(int16_t* half, int feature);
+// run the layers after the accumulator; centipawns for sideToMove
+int nnueEvaluate(const NnueAccumulator& accumulator, int sideToMove);
@@ -1,12 +1,6 @@
 #include "Othello.h"
 #include <iostream>
 
-// Define the 8 directions: N, NE, E, SE, S, SW, W, NW
-const int Othello::DIRECTIONS[8][2] = {
-    {0, -1}, {1, -1}, {1, 0}, {1, 1},
-    {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}
-};
-
 Othello::Othello() : Game() {
     _grid = new Grid(8, 8);
     _consecutivePasses = 0;
@@ -61,23 +55,21 @@ bool Othello::actionForEmptyHolder(BitHolder &holder) {
     int x = square->getColumn();
     int y = square->getRow();
     Player* currentPlayer = getCurrentPlayer();
+    char piece = pieceFor(currentPlayer);
+    std::string state = stateString();
 
-    if (!isValidMove(x, y, currentPlayer)) return false;
-
-    // Place the piece
-    Bit* newPiece = createPiece(currentPlayer);
-    newPiece->setPosition(holder.getPosition());
-    holder.setBit(newPiece);
+    if (!othelloIsValidMove(state, x, y, piece)) return false;
 
-    // Flip all affected pieces
-    flipPieces(x, y, currentPlayer);
+    // Place the piece and flip all affected pieces
+    othelloPlayMove(state, x, y, piece);
+    updateBoard(state);
     _consecutivePasses = 0;
 
     // Check if next player has moves
     Player* nextPlayer = getPlayerAt(1 - currentPlayer->playerNumber());
-    if (!hasValidMove(nextPlayer)) {
+    if (!othelloHasValidMove(state, pieceFor(nextPlayer))) {
         _consecutivePasses++;
-        if (hasValidMove(currentPlayer)) {
+        if (othelloHasValidMove(state, piece)) {
             // Next player passes, current player continues
             return true;
         } else {
@@ -97,151 +89,46 @@ bool Othello::canBitMoveFromTo(Bit &bit, BitHolder &src, BitHolder &dst) {
     return false; // Pieces cannot be moved in Othello
 }
 
-bool Othello::isValidMove(int x, int y, Player* player) const {
-    if (!_grid->isValid(x, y) || _grid->getSquare(x, y)->bit()) return false;
-
-    // Check if placing a piece here would flip at least one opponent piece
-    for (int i = 0; i < 8; i++) {
-        if (checkDirection(x, y, DIRECTIONS[i][0], DIRECTIONS[i][1], player) > 0) {
-            return true;
-        }
-    }
-    return false;
-}
-
-int Othello::checkDirection(int x, int y, int dx, int dy, Player* player) const {
-    int count = 0;
-    int nx = x + dx;
-    int ny = y + dy;
-
-    if (!_grid->isValid(nx, ny)) return 0;
-
-    Bit* firstPiece = _grid->getSquare(nx, ny)->bit();
-    if (!firstPiece || firstPiece->getOwner() == player) return 0;
-
-    // Count opponent pieces in this direction
-    while (_grid->isValid(nx, ny)) {
-        Bit* piece = _grid->getSquare(nx, ny)->bit();
-        if (!piece) return 0;
-        if (piece->getOwner() == player) return count;
-        count++;
-        nx += dx;
-        ny += dy;
-    }
-    return 0;
+char Othello::pieceFor(Player* player) const {
+    return player == getPlayerAt(BLACK_PLAYER) ? '1' : '2';
 }
 
-void Othello::flipPieces(int x, int y, Player* player) {
-    for (int i = 0; i < 8; i++) {
-        int count = checkDirection(x, y, DIRECTIONS[i][0], DIRECTIONS[i][1], player);
-        if (count > 0) {
-            flipInDirection(x, y, DIRECTIONS[i][0], DIRECTIONS[i][1], player, count);
-        }
-    }
-}
-
-void Othello::flipInDirection(int x, int y, int dx, int dy, Player* player, int count) {
-    int nx = x + dx;
-    int ny = y + dy;
-
-    for (int i = 0; i < count; i++) {
-        ChessSquare* square = _grid->getSquare(nx, ny);
-        if (square && square->bit()) {
-            square->destroyBit();
-            Bit* newPiece = createPiece(player);
-            newPiece->setPosition(square->getPosition());
-            square->setBit(newPiece);
-        }
-        nx += dx;
-        ny += dy;
-    }
-}
-
-bool Othello::hasValidMove(Player* player) const {
-    bool hasMove = false;
+// recreate the sprites of every square whose state changed
+void Othello::updateBoard(const std::string& state) {
+    std::string current = stateString();
     _grid->forEachSquare([&](ChessSquare* square, int x, int y) {
-        if (!hasMove && isValidMove(x, y, player)) {
-            hasMove = true;
-        }
-    });
-    return hasMove;
-}
-
-std::vector<std::pair<int, int>> Othello::getValidMoves(Player* player) const {
-    std::vector<std::pair<int, int>> moves;
-    _grid->forEachSquare([&](ChessSquare* square, int x, int y) {
-        if (isValidMove(x, y, player)) {
-            moves.push_back({x, y});
+        char cell = state[y * 8 + x];
+        if (cell == current[y * 8 + x]) return;
+        square->destroyBit();
+        if (cell != '0') {
+            Bit* piece = createPiece(getPlayerAt(cell == '1' ? BLACK_PLAYER : WHITE_PLAYER));
+            piece->setPosition(square->getPosition());
+            square->setBit(piece);
         }
     });
-    return moves;
 }
 
 Player* Othello::checkForWinner() {
-    // Game ends when neither player can move
-    if (_consecutivePasses >= 2 ||
-        (!hasValidMove(getPlayerAt(BLACK_PLAYER)) && !hasValidMove(getPlayerAt(WHITE_PLAYER)))) {
-
-        int blackCount, whiteCount;
-        countPieces(blackCount, whiteCount);
-
-        if (blackCount > whiteCount) return getPlayerAt(BLACK_PLAYER);
-        if (whiteCount > blackCount) return getPlayerAt(WHITE_PLAYER);
-    }
+    // Game ends when neither player can move, which a full board is a case of
+    std::string state = stateString();
+    if (_consecutivePasses >= 2 || othelloIsOver(state)) {
+        int blackCount = othelloCount(state, '1');
+        int whiteCount = othelloCount(state, '2');
 
-    // Check if board is full
-    bool boardFull = true;
-    _grid->forEachSquare([&boardFull](ChessSquare* square, int x, int y) {
-        if (!square->bit()) boardFull = false;
-    });
-
-    if (boardFull) {
-        int blackCount, whiteCount;
-        countPieces(blackCount, whiteCount);
         if (blackCount > whiteCount) return getPlayerAt(BLACK_PLAYER);
         if (whiteCount > blackCount) return getPlayerAt(WHITE_PLAYER);
     }
-
     return nullptr;
 }
 
 bool Othello::checkForDraw() {
-    if (_consecutivePasses >= 2 ||
-        (!hasValidMove(getPlayerAt(BLACK_PLAYER)) && !hasValidMove(getPlayerAt(WHITE_PLAYER)))) {
-        int blackCount, whiteCount;
-        countPieces(blackCount, whiteCount);
-        return blackCount == whiteCount;
-    }
-
-    bool boardFull = true;
-    _grid->forEachSquare([&boardFull](ChessSquare* square, int x, int y) {
-        if (!square->bit()) boardFull = false;
-    });
-
-    if (boardFull) {
-        int blackCount, whiteCount;
-        countPieces(blackCount, whiteCount);
-        return blackCount == whiteCount;
+    std::string state = stateString();
+    if (_consecutivePasses >= 2 || othelloIsOver(state)) {
+        return othelloCount(state, '1') == othelloCount(state, '2');
     }
     return false;
 }
 
-void Othello::countPieces(int &blackCount, int &whiteCount) const {
-    blackCount = 0;
-    whiteCount = 0;
-
-    _grid->forEachSquare([&](ChessSquare* square, int x, int y) {
-        Bit* piece = square->bit();
-        if (piece) {
-            if (piece->getOwner() == getPlayerAt(BLACK_PLAYER)) {
-                blackCount++;
-            } else {
-                whiteCount++;
-            }
-        }
-    });
-}
-
 void Othello::stopGame() {
     _grid->forEachSquare([](ChessSquare* square, int x, int y) {
         square->destroyBit();
@@ -299,7 +186,9 @@ void Othello::updateAI() {
     if (!gameHasAI()) return;
 
     Player* aiPlayer = getCurrentPlayer();
-    std::vector<std::pair<int, int>> validMoves = getValidMoves(aiPlayer);
+    char piece = pieceFor(aiPlayer);
+    std::string state = stateString();
+    std::vector<int> validMoves = othelloValidMoves(state, piece);
 
     if (validMoves.empty()) {
         _consecutivePasses++;
@@ -308,22 +197,18 @@ void Othello::updateAI() {
     }
 
     // Find move that flips the most pieces
-    int bestX = -1, bestY = -1, maxFlips = 0;
+    int bestMove = -1, maxFlips = 0;
 
-    for (const auto& move : validMoves) {
-        int x = move.first, y = move.second, totalFlips = 0;
-        for (int i = 0; i < 8; i++) {
-            totalFlips += checkDirection(x, y, DIRECTIONS[i][0], DIRECTIONS[i][1], aiPlayer);
-        }
+    for (int move : validMoves) {
+        int totalFlips = othelloFlipCount(state, move % 8, move / 8, piece);
         if (totalFlips > maxFlips) {
             maxFlips = totalFlips;
-            bestX = x;
-            bestY = y;
+            bestMove = move;
         }
     }
 
-    if (bestX >= 0 && bestY >= 0) {
-        actionForEmptyHolder(*_grid->getSquare(bestX, bestY));
+    if (bestMove >= 0) {
+        actionForEmptyHolder(*_grid->getSquare(bestMove % 8, bestMove / 8));
     }
 }
 
@@ -1,5 +1,6 @@
 #pragma once
 #include "Game.h"
+#include "OthelloRules.h"
 #include <vector>
 
 // NOTE: This implementation assumes black.png and white.png exist in resources.
@@ -33,18 +34,12 @@ private:
     static const int BLACK_PLAYER = 0;
     static const int WHITE_PLAYER = 1;
 
-    // Direction vectors for checking all 8 directions
-    static const int DIRECTIONS[8][2];
-
     // Helper methods
     Bit*        createPiece(Player* player);
-    bool        isValidMove(int x, int y, Player* player) const;
-    int         checkDirection(int x, int y, int dx, int dy, Player* player) const;
-    void        flipPieces(int x, int y, Player* player);
-    void        flipInDirection(int x, int y, int dx, int dy, Player* player, int count);
-    bool        hasValidMove(Player* player) const;
-    void        countPieces(int &blackCount, int &whiteCount) const;
-    std::vector<std::pair<int, int>> getValidMoves(Player* player) const;
+    // the player's character in the state string
+    char        pieceFor(Player* player) const;
+    // make the sprites match a state the rules have played a move on
+    void        updateBoard(const std::string& state);
     void        showValidMoves(Player* player);
     void        clearValidMoveIndicators();
 
@@ -0,0 +1,95 @@
+#include "OthelloRules.h"
+#include <algorithm>
+
+// Define the 8 directions: N, NE, E, SE, S, SW, W, NW
+static const int Directions[8][2] = {
+    {0, -1}, {1, -1}, {1, 0}, {1, 1},
+    {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}
+};
+
+static bool isOnBoard(int x, int y)
+{
+    return x >= 0 && x < 8 && y >= 0 && y < 8;
+}
+
+// the run of opponent discs from x, y towards dx, dy, if piece closes it off at the far end
+static int checkDirection(const std::string& state, int x, int y, int dx, int dy, char piece)
+{
+    int count = 0;
+    int nx = x + dx;
+    int ny = y + dy;
+    while (isOnBoard(nx, ny)) {
+        char cell = state[ny * 8 + nx];
+        if (cell == '0') {
+            return 0;
+        }
+        if (cell == piece) {
+            return count;
+        }
+        count++;
+        nx += dx;
+        ny += dy;
+    }
+    return 0;
+}
+
+int othelloFlipCount(const std::string& state, int x, int y, char piece)
+{
+    if (!isOnBoard(x, y) || state[y * 8 + x] != '0') {
+        return 0;
+    }
+    int flips = 0;
+    for (int i = 0; i < 8; i++) {
+        flips += checkDirection(state, x, y, Directions[i][0], Directions[i][1], piece);
+    }
+    return flips;
+}
+
+bool othelloIsValidMove(const std::string& state, int x, int y, char piece)
+{
+    return othelloFlipCount(state, x, y, piece) > 0;
+}
+
+bool othelloHasValidMove(const std::string& state, char piece)
+{
+    for (int index = 0; index < 64; index++) {
+        if (othelloIsValidMove(state, index % 8, index / 8, piece)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<int> othelloValidMoves(const std::string& state, char piece)
+{
+    std::vector<int> moves;
+    for (int index = 0; index < 64; index++) {
+        if (othelloIsValidMove(state, index % 8, index / 8, piece)) {
+            moves.push_back(index);
+        }
+    }
+    return moves;
+}
+
+void othelloPlayMove(std::string& state, int x, int y, char piece)
+{
+    // the eight rays from x, y never cross, so flipping one can't change what another flips
+    for (int i = 0; i < 8; i++) {
+        int dx = Directions[i][0], dy = Directions[i][1];
+        int count = checkDirection(state, x, y, dx, dy, piece);
+        for (int step = 1; step <= count; step++) {
+            state[(y + dy * step) * 8 + x + dx * step] = piece;
+        }
+    }
+    state[y * 8 + x] = piece;
+}
+
+bool othelloIsOver(const std::string& state)
+{
+    return !othelloHasValidMove(state, '1') && !othelloHasValidMove(state, '2');
+}
+
+int othelloCount(const std::string& state, char piece)
+{
+    return (int)std::count(state.begin(), state.end(), piece);
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "GameRules.h"
+#include <string>
+#include <vector>
+
+//
+// othello rules on the state string alone, no sprites or textures
+// the state is 64 characters, row by row: '0' empty, '1' for black (player 0), '2' for white (player 1).
+// piece is the character of the side making the move
+//
+
+// how many pieces a disc on x, y would flip, 0 if the square is taken or the move flips nothing
+int othelloFlipCount(const std::string& state, int x, int y, char piece);
+
+bool othelloIsValidMove(const std::string& state, int x, int y, char piece);
+bool othelloHasValidMove(const std::string& state, char piece);
+// every square piece can play on, as y * 8 + x in board order
+std::vector<int> othelloValidMoves(const std::string& state, char piece);
+
+// put a disc on x, y and flip everything it outflanks; the move has to be valid
+void othelloPlayMove(std::string& state, int x, int y, char piece);
+
+// neither side can move, which includes a full board
+bool othelloIsOver(const std::string& state);
+int othelloCount(const std::string& state, char piece);
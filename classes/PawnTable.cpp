@@ -0,0 +1,109 @@
+#include "PawnTable.h"
+#include <algorithm>
+#include <bit>
+
+constexpr uint64_t NotCol1(0xFEFEFEFEFEFEFEFEULL);  // mask along the first column
+constexpr uint64_t NotCol8(0x7F7F7F7F7F7F7F7FULL);  // mask along the last column
+
+// penalties per pawn, and bonuses for passers by how far up the board they are, as midgame/endgame pairs
+static const int DoubledPenalty[2] = { 10, 25 };
+static const int IsolatedPenalty[2] = { 10, 15 };
+static const int BackwardPenalty[2] = { 8, 10 };
+static const int PassedBonus[2][8] = {
+    { 0, 5, 10, 15, 30, 50, 80, 0 },
+    { 0, 10, 15, 25, 45, 75, 120, 0 }
+};
+
+// smear every bit up or down its column to the edge of the board
+static uint64_t northFill(uint64_t bits)
+{
+    bits |= bits << 8;
+    bits |= bits << 16;
+    return bits | (bits << 32);
+}
+
+static uint64_t southFill(uint64_t bits)
+{
+    bits |= bits >> 8;
+    bits |= bits >> 16;
+    return bits | (bits >> 32);
+}
+
+// squares ahead of the pawns from color's side, not counting their own
+static uint64_t frontSpan(int color, uint64_t pawns)
+{
+    return color == White ? northFill(pawns << 8) : southFill(pawns >> 8);
+}
+
+static uint64_t pawnAttacks(int color, uint64_t pawns)
+{
+    return color == White ?
+        ((pawns & NotCol1) << 7) | ((pawns & NotCol8) << 9) :
+        ((pawns & NotCol1) >> 9) | ((pawns & NotCol8) >> 7);
+}
+
+static uint64_t attackSpan(int color, uint64_t pawns)
+{
+    uint64_t attacks = pawnAttacks(color, pawns);
+    return color == White ? northFill(attacks) : southFill(attacks);
+}
+
+static void analyse(const Position& position, PawnEntry& entry)
+{
+    int score[2] = { 0, 0 };
+    for (int color = White; color <= Black; color++) {
+        entry.attackSpans[color] = attackSpan(color, position.piecesOf(color, Pawn));
+    }
+
+    for (int us = White; us <= Black; us++) {
+        int them = us ^ 1;
+        int sign = us == White ? 1 : -1;
+        uint64_t ours = position.piecesOf(us, Pawn);
+        uint64_t theirs = position.piecesOf(them, Pawn);
+
+        uint64_t files = northFill(southFill(ours));
+        uint64_t neighbourFiles = ((files & NotCol1) >> 1) | ((files & NotCol8) << 1);
+        uint64_t isolated = ours & ~neighbourFiles;
+        uint64_t doubled = ours & frontSpan(us, ours);
+        uint64_t stops = us == White ? ours << 8 : ours >> 8;
+        uint64_t backwardStops = stops & pawnAttacks(them, theirs) & ~entry.attackSpans[us];
+        uint64_t backward = us == White ? backwardStops >> 8 : backwardStops << 8;
+        // of doubled pawns only the front one counts as passed
+        entry.passed[us] = ours & ~frontSpan(them, theirs) & ~entry.attackSpans[them] & ~frontSpan(them, ours);
+
+        for (int phase = 0; phase < 2; phase++) {
+            int value = -DoubledPenalty[phase] * std::popcount(doubled)
+                      - IsolatedPenalty[phase] * std::popcount(isolated)
+                      - BackwardPenalty[phase] * std::popcount(backward & ~isolated);
+            for (uint64_t bits = entry.passed[us]; bits; bits &= bits - 1) {
+                int row = std::countr_zero(bits) / 8;
+                value += PassedBonus[phase][us == White ? row : 7 - row];
+            }
+            score[phase] += sign * value;
+        }
+    }
+    entry.midgame = (int16_t)score[0];
+    entry.endgame = (int16_t)score[1];
+}
+
+PawnTable::PawnTable()
+    : _entries(Size)
+{
+    clear();
+}
+
+void PawnTable::clear()
+{
+    // an all zero entry is exactly what a board without pawns analyses to, so empty slots need no marker
+    std::fill(_entries.begin(), _entries.end(), PawnEntry{});
+}
+
+const PawnEntry& PawnTable::probe(const Position& position)
+{
+    PawnEntry& entry = _entries[position.pawnKey & (Size - 1)];
+    if (entry.key != position.pawnKey) {
+        entry.key = position.pawnKey;
+        analyse(position, entry);
+    }
+    return entry;
+}
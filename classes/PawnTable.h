@@ -0,0 +1,38 @@
+#pragma once
+
+#include "Position.h"
+
+//
+// pawn structure, cached by the pawn-only hash key
+// pawns move rarely and are never added, so the same few structures turn up at node after node.
+// each one is worked out once with whole-board shifts and fills, never a square at a time:
+// - passed: no enemy pawn ahead on its own file or either side
+// - isolated: no friendly pawn on either neighbouring file
+// - doubled: a friendly pawn behind it on the same file
+// - backward: the square in front is covered by an enemy pawn and no friendly pawn can ever defend it
+// - attack span: every square a side's pawns could attack as they advance
+//
+struct PawnEntry
+{
+    uint64_t    key;
+    uint64_t    passed[2];          // [ChessColor]
+    uint64_t    attackSpans[2];
+    int16_t     midgame;            // white minus black
+    int16_t     endgame;
+};
+
+// one per search thread, so it needs no locking
+class PawnTable
+{
+public:
+    PawnTable();
+
+    // the entry for the position's pawns, analysed now if the table didn't have them
+    const PawnEntry& probe(const Position& position);
+    void        clear();
+
+private:
+    static constexpr int Size = 16384;
+
+    std::vector<PawnEntry> _entries;
+};
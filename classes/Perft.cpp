@@ -0,0 +1,337 @@
+#include "Perft.h"
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+const PerftPosition PerftSuite[] = {
+    { "start position", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+        { 20, 400, 8902, 197281, 4865609, 119060324, 3195901860 } },
+    { "kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        { 48, 2039, 97862, 4085603, 193690690, 8031647685 } },
+    { "rook endgame, en passant pins", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+        { 14, 191, 2812, 43238, 674624, 11030083, 178633661 } },
+    { "promotions and castling", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+        { 6, 264, 9467, 422333, 15833292, 706045033 } },
+    { "promotion captures", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+        { 44, 1486, 62379, 2103487, 89941194 } },
+    { "symmetrical middlegame", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+        { 46, 2079, 89890, 3894594, 164075551, 6923051137 } },
+
+    // edge cases, each one aimed at a single rule. only the deepest count of each is published;
+    // the shallower ones are from this generator once it matched that
+    { "illegal en passant, rook pin", "3k4/3p4/8/K1P4r/8/8/8/8 b - - 0 1",
+        { 18, 92, 1670, 10138, 185429, 1134888 } },
+    { "illegal en passant, bishop pin", "8/8/4k3/8/2p5/8/B2P2K1/8 w - - 0 1",
+        { 13, 102, 1266, 10276, 135655, 1015133 } },
+    { "en passant gives check", "8/8/1k6/2b5/2pP4/8/5K2/8 b - d3 0 1",
+        { 15, 126, 1928, 13931, 206379, 1440467 } },
+    { "short castling gives check", "5k2/8/8/8/8/8/8/4K2R w K - 0 1",
+        { 15, 66, 1198, 6399, 120330, 661072 } },
+    { "long castling gives check", "3k4/8/8/8/8/8/8/R3K3 w Q - 0 1",
+        { 16, 71, 1286, 7418, 141077, 803711 } },
+    { "castling rights", "r3k2r/1b4bq/8/8/8/8/7B/R3K2R w KQkq - 0 1",
+        { 26, 1141, 27826, 1274206 } },
+    { "castling prevented", "r3k2r/8/3Q4/8/8/5q2/8/R3K2R b KQkq - 0 1",
+        { 44, 1494, 50509, 1720476 } },
+    { "promote out of check", "2K2r2/4P3/8/8/8/8/8/3k4 w - - 0 1",
+        { 11, 133, 1442, 19174, 266199, 3821001 } },
+    { "discovered check", "8/8/1P2K3/8/2n5/1q6/8/5k2 b - - 0 1",
+        { 29, 165, 5160, 31961, 1004658 } },
+    { "promote to give check", "4k3/1P6/8/8/8/8/K7/8 w - - 0 1",
+        { 9, 40, 472, 2661, 38983, 217342 } },
+    { "underpromote to check", "8/P1k5/K7/8/8/8/8/8 w - - 0 1",
+        { 6, 27, 273, 1329, 18135, 92683 } },
+    { "self stalemate", "K1k5/8/P7/8/8/8/8/8 w - - 0 1",
+        { 2, 6, 13, 63, 382, 2217 } },
+    { "stalemate and checkmate", "8/k1P5/8/1K6/8/8/8/8 w - - 0 1",
+        { 10, 25, 268, 926, 10857, 43261, 567584 } },
+    { "stalemate and checkmate 2", "8/8/2k5/5q2/5n2/8/5K2/8 b - - 0 1",
+        { 37, 183, 6559, 23527 } },
+};
+
+const int PerftSuiteSize = sizeof(PerftSuite) / sizeof(PerftSuite[0]);
+
+PerftHashTable::PerftHashTable(size_t megabytes)
+{
+    _entryCount = megabytes * 1024 * 1024 / sizeof(Entry);
+    if (_entryCount == 0) {
+        _entryCount = 1;
+    }
+    _entries = new Entry[_entryCount];
+    memset(_entries, 0, _entryCount * sizeof(Entry));
+}
+
+PerftHashTable::~PerftHashTable()
+{
+    delete[] _entries;
+}
+
+// the same position at a different depth has a different count, so fold the depth into the key
+static uint64_t perftKey(uint64_t key, int depth)
+{
+    return key ^ (0x9E3779B97F4A7C15ULL * (uint64_t)(depth + 1));
+}
+
+bool PerftHashTable::probe(uint64_t key, int depth, uint64_t& nodes) const
+{
+    uint64_t hashKey = perftKey(key, depth);
+    Entry& entry = _entries[hashKey % _entryCount];
+    uint64_t data = std::atomic_ref<uint64_t>(entry.data).load(std::memory_order_relaxed);
+    uint64_t check = std::atomic_ref<uint64_t>(entry.keyXorData).load(std::memory_order_relaxed);
+    if ((check ^ data) != hashKey || (int)(data >> 56) != depth) {
+        return false;
+    }
+    nodes = data & 0x00FFFFFFFFFFFFFFULL;
+    return true;
+}
+
+void PerftHashTable::store(uint64_t key, int depth, uint64_t nodes)
+{
+    uint64_t hashKey = perftKey(key, depth);
+    Entry& entry = _entries[hashKey % _entryCount];
+    uint64_t data = nodes | (uint64_t)depth << 56;
+    std::atomic_ref<uint64_t>(entry.data).store(data, std::memory_order_relaxed);
+    std::atomic_ref<uint64_t>(entry.keyXorData).store(hashKey ^ data, std::memory_order_relaxed);
+}
+
+template <SliderBackend Backend>
+static uint64_t countLeaves(Position& position, int depth, PerftHashTable* hash)
+{
+    if (depth == 0) {
+        return 1;
+    }
+    // a hit saves generating the moves as well as walking them
+    uint64_t nodes = 0;
+    if (depth > 1 && hash && hash->probe(position.key, depth, nodes)) {
+        return nodes;
+    }
+
+    MoveList moves;
+    position.generateAllMoves<Backend>(moves);
+    if (depth == 1) {
+        return moves.size();
+    }
+    for (auto move : moves) {
+        position.makeMove(move);
+        nodes += countLeaves<Backend>(position, depth - 1, hash);
+        position.unmakeMove();
+    }
+    if (hash) {
+        hash->store(position.key, depth, nodes);
+    }
+    return nodes;
+}
+
+// the slider backend is picked here once for the whole tree
+uint64_t perft(Position& position, int depth, PerftHashTable* hash)
+{
+    if (SliderBackendInUse == SliderPext) {
+        return countLeaves<SliderPext>(position, depth, hash);
+    }
+    return countLeaves<SliderMagic>(position, depth, hash);
+}
+
+//
+// count the subtree under each root move
+// each worker takes the next unsearched root move until there are none left, so a thread that
+// drew a small subtree just picks up another one
+//
+static std::vector<uint64_t> countRootMoves(const Position& position, const MoveList& moves, int depth,
+                                            int threads, PerftHashTable* hash)
+{
+    std::vector<uint64_t> counts(moves.size(), 1);
+    if (depth <= 1) {
+        return counts;
+    }
+    std::atomic<int> nextMove = 0;
+    auto worker = [&]() {
+        Position local = position;
+        for (int i = nextMove++; i < moves.size(); i = nextMove++) {
+            local.makeMove(moves[i]);
+            counts[i] = perft(local, depth - 1, hash);
+            local.unmakeMove();
+        }
+    };
+    std::vector<std::thread> pool;
+    for (int i = 1; i < threads; i++) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : pool) {
+        thread.join();
+    }
+    return counts;
+}
+
+uint64_t perftDivide(Position& position, int depth, int threads, PerftHashTable* hash)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    MoveList moves;
+    position.generateAllMoves(moves);
+    std::vector<uint64_t> counts = countRootMoves(position, moves, depth, threads, hash);
+
+    uint64_t nodes = 0;
+    for (int i = 0; i < moves.size(); i++) {
+        std::cout << moves[i].notation() << ": " << counts[i] << std::endl;
+        nodes += counts[i];
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << std::endl << "moves: " << moves.size() << std::endl;
+    std::cout << "nodes: " << nodes << std::endl;
+    std::cout << "time: " << (int)(seconds * 1000) << " ms" << std::endl;
+    std::cout << "nps: " << (uint64_t)(seconds > 0 ? nodes / seconds : 0) << std::endl;
+    return nodes;
+}
+
+static uint64_t perftParallel(Position& position, int depth, int threads, PerftHashTable* hash)
+{
+    if (threads <= 1) {
+        return perft(position, depth, hash);
+    }
+    MoveList moves;
+    position.generateAllMoves(moves);
+    uint64_t nodes = 0;
+    for (uint64_t count : countRootMoves(position, moves, depth, threads, hash)) {
+        nodes += count;
+    }
+    return depth > 0 ? nodes : 1;
+}
+
+bool runPerftSuite(int maxDepth, int threads, PerftHashTable* hash)
+{
+    bool allPassed = true;
+    uint64_t totalNodes = 0;
+    auto suiteStart = std::chrono::steady_clock::now();
+
+    Position position;
+    for (int i = 0; i < PerftSuiteSize; i++) {
+        const PerftPosition& test = PerftSuite[i];
+        int depth = maxDepth < 7 ? maxDepth : 7;
+        while (depth > 0 && test.nodes[depth - 1] == 0) {
+            depth--;
+        }
+        if (depth == 0) {
+            continue;
+        }
+
+        position.setFEN(test.fen);
+        auto start = std::chrono::steady_clock::now();
+        uint64_t nodes = perftParallel(position, depth, threads, hash);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        totalNodes += nodes;
+
+        bool passed = nodes == test.nodes[depth - 1];
+        allPassed = allPassed && passed;
+        std::cout << (passed ? "ok    " : "FAIL  ") << test.name << " depth " << depth << ": " << nodes;
+        if (!passed) {
+            std::cout << " expected " << test.nodes[depth - 1];
+        }
+        std::cout << " (" << (uint64_t)(seconds > 0 ? nodes / seconds : 0) << " nps)" << std::endl;
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - suiteStart).count();
+    std::cout << std::endl << (allPassed ? "all passed" : "FAILURES") << ", " << totalNodes << " nodes, "
+              << (uint64_t)(seconds > 0 ? totalNodes / seconds : 0) << " nps" << std::endl;
+    return allPassed;
+}
+
+// the first incrementally kept field that differs from a from-scratch setup, nullptr if none
+static const char* inconsistentField(const Position& position, Position& fresh)
+{
+    char fen[MaxFENLength];
+    position.toFEN(fen);
+    fresh.setFEN(fen);
+
+    if (memcmp(position.pieces, fresh.pieces, sizeof(position.pieces)) != 0 || position.occupancy != fresh.occupancy
+        || memcmp(position.board, fresh.board, sizeof(position.board)) != 0) {
+        return "board";
+    }
+    if (position.key != fresh.key) {
+        return "key";
+    }
+    if (position.pawnKey != fresh.pawnKey) {
+        return "pawn key";
+    }
+    if (position.materialKey != fresh.materialKey) {
+        return "material key";
+    }
+    if (position.midgameScore != fresh.midgameScore || position.endgameScore != fresh.endgameScore) {
+        return "piece-square totals";
+    }
+    if (position.accumulators.empty() != fresh.accumulators.empty()
+        || (!fresh.accumulators.empty()
+            && memcmp(&position.accumulators.back(), &fresh.accumulators.back(), sizeof(NnueAccumulator)) != 0)) {
+        return "accumulator";
+    }
+    return nullptr;
+}
+
+static void printLine(const std::vector<BitMove>& line)
+{
+    for (BitMove move : line) {
+        std::cout << " " << move.notation();
+    }
+    std::cout << std::endl;
+}
+
+static bool verifyTree(Position& position, int depth, Position& fresh, std::vector<BitMove>& line, uint64_t& nodes)
+{
+    nodes++;
+    if (const char* field = inconsistentField(position, fresh)) {
+        std::cout << field << " out of step after";
+        printLine(line);
+        return false;
+    }
+    if (depth == 0) {
+        return true;
+    }
+
+    MoveList moves;
+    position.generateAllMoves(moves);
+    for (auto move : moves) {
+        uint64_t key = position.key;
+        position.makeMove(move);
+        line.push_back(move);
+        bool consistent = verifyTree(position, depth - 1, fresh, line, nodes);
+        position.unmakeMove();
+        if (!consistent) {
+            return false;
+        }
+        const char* field = position.key != key ? "key" : inconsistentField(position, fresh);
+        if (field) {
+            std::cout << field << " not restored by unmaking";
+            printLine(line);
+            return false;
+        }
+        line.pop_back();
+    }
+    return true;
+}
+
+bool perftVerify(Position& position, int depth)
+{
+    Position fresh;
+    std::vector<BitMove> line;
+    uint64_t nodes = 0;
+    bool consistent = verifyTree(position, depth, fresh, line, nodes);
+    std::cout << (consistent ? "consistent" : "INCONSISTENT") << ", " << nodes << " positions checked"
+              << (position.accumulators.empty() ? " (no network, accumulators not checked)" : "") << std::endl;
+    return consistent;
+}
+
+bool runVerifySuite(int depth)
+{
+    bool allConsistent = true;
+    Position position;
+    for (int i = 0; i < PerftSuiteSize; i++) {
+        position.setFEN(PerftSuite[i].fen);
+        std::cout << PerftSuite[i].name << " depth " << depth << ": ";
+        allConsistent = perftVerify(position, depth) && allConsistent;
+    }
+    std::cout << std::endl << (allConsistent ? "all consistent" : "FAILURES") << std::endl;
+    return allConsistent;
+}
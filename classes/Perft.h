@@ -0,0 +1,62 @@
+#pragma once
+
+#include "Position.h"
+
+//
+// perft: count every leaf of the legal move tree to a fixed depth
+// the counts for well known positions are published, so any move generator bug shows up as a
+// wrong number; divide prints the count under each root move to narrow down which move is wrong
+//
+
+// a position with its published node counts, nodes[d - 1] is depth d, 0 where not listed
+struct PerftPosition
+{
+    const char* name;
+    const char* fen;
+    uint64_t    nodes[7];
+};
+
+extern const PerftPosition PerftSuite[];
+extern const int PerftSuiteSize;
+
+//
+// subtree counts cached by position and remaining depth
+// transpositions are everywhere deep in the tree, so this cuts deep perft by a large factor.
+// slots are lockless in the same way as the transposition table, so every worker shares one
+//
+class PerftHashTable
+{
+public:
+    PerftHashTable(size_t megabytes);
+    ~PerftHashTable();
+
+    bool        probe(uint64_t key, int depth, uint64_t& nodes) const;
+    void        store(uint64_t key, int depth, uint64_t nodes);
+
+private:
+    struct Entry
+    {
+        uint64_t    keyXorData;
+        uint64_t    data;       // node count, remaining depth in the top byte
+    };
+
+    Entry*      _entries;
+    size_t      _entryCount;
+};
+
+// the leaf level is counted straight from the length of the legal move list (bulk counting)
+uint64_t perft(Position& position, int depth, PerftHashTable* hash = nullptr);
+
+// perft with a line per root move, then the total and nodes per second
+// with more than one thread the root moves are handed out to a pool of workers, each on its own copy
+uint64_t perftDivide(Position& position, int depth, int threads = 1, PerftHashTable* hash = nullptr);
+
+// run every suite position at the deepest listed depth up to maxDepth; true if all match
+bool runPerftSuite(int maxDepth, int threads = 1, PerftHashTable* hash = nullptr);
+
+// walk the tree checking everything makeMove and unmakeMove keep up to date (the keys, piece-square
+// totals and nnue accumulators) against the same position set up from its FEN; stops at the first mismatch
+bool perftVerify(Position& position, int depth);
+
+// perftVerify on every suite position to depth; true if none went out of step
+bool runVerifySuite(int depth);
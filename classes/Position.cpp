@@ -0,0 +1,1094 @@
+#include "Position.h"
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+
+const int SeeValues[7] = { 0, 100, 320, 330, 500, 900, 20000 };
+
+void Position::clear()
+{
+    memset(pieces, 0, sizeof(pieces));
+    memset(board, 0, sizeof(board));
+    occupancy = 0ULL;
+    key = 0ULL;
+    midgameScore = 0;
+    endgameScore = 0;
+    materialKey = 0ULL;
+    pawnKey = 0ULL;
+    sideToMove = White;
+    castling = NoCastling;
+    enPassant = NoSquare;
+    halfmoveClock = 0;
+    fullmoveNumber = 1;
+    undoStack.clear();
+    undoStack.reserve(256);
+    accumulators.clear();
+}
+
+void Position::putPiece(int color, ChessPiece piece, int square)
+{
+    uint64_t bit = 1ULL << square;
+    pieces[color][piece] |= bit;
+    pieces[color][NoPiece] |= bit;
+    occupancy |= bit;
+    board[square] = pieceTag(color, piece);
+    key ^= Zobrist.pieceSquare[color][piece][square];
+    midgameScore += PieceSquare.midgame[color][piece][square];
+    endgameScore += PieceSquare.endgame[color][piece][square];
+    materialKey += 1ULL << materialKeyShift(color, piece);
+    if (piece == Pawn) {
+        pawnKey ^= Zobrist.pieceSquare[color][Pawn][square];
+    }
+}
+
+void Position::removePiece(int square)
+{
+    uint8_t tag = board[square];
+    if (!tag) {
+        return;
+    }
+    uint64_t bit = 1ULL << square;
+    pieces[tagColor(tag)][tagPiece(tag)] &= ~bit;
+    pieces[tagColor(tag)][NoPiece] &= ~bit;
+    occupancy &= ~bit;
+    board[square] = 0;
+    key ^= Zobrist.pieceSquare[tagColor(tag)][tagPiece(tag)][square];
+    midgameScore -= PieceSquare.midgame[tagColor(tag)][tagPiece(tag)][square];
+    endgameScore -= PieceSquare.endgame[tagColor(tag)][tagPiece(tag)][square];
+    materialKey -= 1ULL << materialKeyShift(tagColor(tag), tagPiece(tag));
+    if (tagPiece(tag) == Pawn) {
+        pawnKey ^= Zobrist.pieceSquare[tagColor(tag)][Pawn][square];
+    }
+}
+
+void Position::movePiece(int from, int to)
+{
+    uint8_t tag = board[from];
+    uint64_t fromTo = (1ULL << from) | (1ULL << to);
+    pieces[tagColor(tag)][tagPiece(tag)] ^= fromTo;
+    pieces[tagColor(tag)][NoPiece] ^= fromTo;
+    occupancy ^= fromTo;
+    board[from] = 0;
+    board[to] = tag;
+    key ^= Zobrist.pieceSquare[tagColor(tag)][tagPiece(tag)][from] ^ Zobrist.pieceSquare[tagColor(tag)][tagPiece(tag)][to];
+    midgameScore += PieceSquare.midgame[tagColor(tag)][tagPiece(tag)][to] - PieceSquare.midgame[tagColor(tag)][tagPiece(tag)][from];
+    endgameScore += PieceSquare.endgame[tagColor(tag)][tagPiece(tag)][to] - PieceSquare.endgame[tagColor(tag)][tagPiece(tag)][from];
+    if (tagPiece(tag) == Pawn) {
+        pawnKey ^= Zobrist.pieceSquare[tagColor(tag)][Pawn][from] ^ Zobrist.pieceSquare[tagColor(tag)][Pawn][to];
+    }
+}
+
+uint64_t Position::computeKey() const
+{
+    uint64_t hash = 0ULL;
+    for (int square = 0; square < 64; square++) {
+        if (board[square]) {
+            hash ^= Zobrist.pieceSquare[tagColor(board[square])][tagPiece(board[square])][square];
+        }
+    }
+    hash ^= Zobrist.castling[castling];
+    if (enPassant != NoSquare) {
+        hash ^= Zobrist.enPassantFile[enPassant % 8];
+    }
+    if (sideToMove == Black) {
+        hash ^= Zobrist.blackToMove;
+    }
+    return hash;
+}
+
+int Position::kingSquare(int color) const
+{
+    uint64_t king = pieces[color][King];
+    return king ? std::countr_zero(king) : NoSquare;
+}
+
+bool Position::isRepetition() const
+{
+    // only positions with the same side to move can match, and nothing before the last
+    // irreversible move can come round again
+    int earliest = (int)undoStack.size() - halfmoveClock;
+    for (int i = (int)undoStack.size() - 2; i >= 0 && i >= earliest; i -= 2) {
+        if (undoStack[i].key == key) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int Position::repetitionCount() const
+{
+    int count = 0;
+    int earliest = (int)undoStack.size() - halfmoveClock;
+    for (int i = (int)undoStack.size() - 2; i >= 0 && i >= earliest; i -= 2) {
+        count += undoStack[i].key == key;
+    }
+    return count;
+}
+
+template <SliderBackend Backend>
+bool Position::isSquareAttacked(int square, int byColor) const
+{
+    if (square == NoSquare) {
+        return false;
+    }
+    // look outwards from the square with each piece's attack pattern and see if it lands on one
+    if (PawnAttacks[byColor ^ 1][square] & pieces[byColor][Pawn]) {
+        return true;
+    }
+    if (KnightAttacks[square] & pieces[byColor][Knight]) {
+        return true;
+    }
+    if (KingAttacks[square] & pieces[byColor][King]) {
+        return true;
+    }
+    uint64_t queens = pieces[byColor][Queen];
+    if (getBishopAttacks<Backend>(square, occupancy) & (pieces[byColor][Bishop] | queens)) {
+        return true;
+    }
+    return getRookAttacks<Backend>(square, occupancy) & (pieces[byColor][Rook] | queens);
+}
+
+//
+// read a FEN string into the position. just the board part is fine too, the rest then defaults
+// to white to move with no castling or en passant
+//
+bool Position::setFEN(std::string_view fen)
+{
+    clear();
+
+    int y = 7;
+    int x = 0;
+    int field = 0;
+    bool valid = true;
+    bool afterDigit = false;
+    // read wide, the clock itself is a byte
+    int halfmoves = 0;
+    for (char fen_char : fen) {
+        // go to next row when reaching
+        // - '/' for a new row on the board
+        // - ' ' for breaks in notation between boardstate, castling, enpessant, etc.
+        if (fen_char == '/' && field == 0) {
+            // every rank has to be full before the next starts, and there are only seven breaks
+            if (x != 8 || y == 0) {
+                valid = false;
+            }
+            y--;
+            x = 0;
+            afterDigit = false;
+            continue;
+        }
+        if (fen_char == ' ') {
+            // field 0 | board
+            // field 1 | set turn for player
+            // field 2 | set castling availability for each player
+            // field 3 | determine enpessant availability
+            // field 4 | half moves
+            // field 5 | full moves
+            field++;
+            if (field == 4) {
+                halfmoves = 0;
+            } else if (field == 5) {
+                fullmoveNumber = 0;
+            }
+            continue;
+        }
+
+        char fen_lower = tolower(fen_char);
+        if (field == 0) {
+            if (!isdigit(fen_char)) {
+                ChessPiece piece = Pawn;
+                switch(fen_lower) {
+                    case 'p':
+                        break;
+                    case 'r':
+                        piece = Rook;
+                        break;
+                    case 'n':
+                        piece = Knight;
+                        break;
+                    case 'b':
+                        piece = Bishop;
+                        break;
+                    case 'q':
+                        piece = Queen;
+                        break;
+                    case 'k':
+                        piece = King;
+                        break;
+                    default:
+                        valid = false;
+                        break;
+                }
+                if (x < 8 && y >= 0 && valid) {
+                    putPiece(std::isupper(fen_char) ? White : Black, piece, y * 8 + x);
+                } else {
+                    valid = false;
+                }
+                // move one column to the right after each iteration by default
+                x += 1;
+                afterDigit = false;
+            }
+            // check for numbers 
+            else { 
+                // skip columns based on fen_char number, never past the end of the rank.
+                // a run of empty squares is always written as one digit, so "53" isn't a rank
+                int skip = fen_char - '0';
+                if (skip < 1 || skip > 8 - x || afterDigit) {
+                    valid = false;
+                }
+                x += skip;
+                afterDigit = true;
+            }
+        } else if (field == 1) {  // check turn
+            sideToMove = fen_lower == 'b' ? Black : White;
+        } else if (field == 2) {
+            switch (fen_char) {
+                case 'K': castling |= WhiteKingSide; break;
+                case 'Q': castling |= WhiteQueenSide; break;
+                case 'k': castling |= BlackKingSide; break;
+                case 'q': castling |= BlackQueenSide; break;
+                default: break;  // '-' nobody can castle
+            }
+        } else if (field == 3) {  // en pessant rules
+            if (fen_lower >= 'a' && fen_lower <= 'h') {
+                enPassant = fen_lower - 'a';
+            } else if (isdigit(fen_char) && enPassant != NoSquare) {
+                enPassant += (fen_char - '1') * 8;
+            }
+        } else if (field == 4 && isdigit(fen_char)) {
+            halfmoves = std::min(halfmoves * 10 + (fen_char - '0'), 1000);
+        } else if (field == 5 && isdigit(fen_char)) {
+            fullmoveNumber = fullmoveNumber * 10 + (fen_char - '0');
+        }
+    }
+    // the fifty move rule only asks whether the clock has reached 100, and capping it there leaves
+    // a search's worth of moves before the byte could wrap
+    halfmoveClock = (uint8_t)std::min(halfmoves, 100);
+    // the move generator and search assume exactly one king a side
+    if (std::popcount(pieces[White][King]) != 1 || std::popcount(pieces[Black][King]) != 1) {
+        valid = false;
+    }
+    // a castling right only stands while its king and rook are both still on their home squares
+    const int rookHomes[4] = { 7, 0, 63, 56 };  // in CastlingRights bit order
+    for (int i = 0; i < 4; i++) {
+        int color = i < 2 ? White : Black;
+        if (!(pieces[color][King] & (1ULL << (color == White ? 4 : 60))) || !(pieces[color][Rook] & (1ULL << rookHomes[i]))) {
+            castling &= ~(1 << i);
+        }
+    }
+    // an en passant square off the 3rd or 6th row can't come from a double push
+    if (enPassant != NoSquare && enPassant / 8 != (sideToMove == White ? 5 : 2)) {
+        enPassant = NoSquare;
+    }
+    if (fullmoveNumber == 0) {
+        fullmoveNumber = 1;
+    }
+    key = computeKey();
+    resetAccumulators();
+    return valid && y == 0 && x == 8;
+}
+
+int Position::toFEN(char* buffer) const
+{
+    const char* notation = "0pnbrqk";
+    char* out = buffer;
+
+    // field 0 | board, from a8 across each row and down to h1
+    for (int y = 7; y >= 0; y--) {
+        int emptyCount = 0;
+        for (int x = 0; x < 8; x++) {
+            uint8_t tag = board[y * 8 + x];
+            if (!tag) {
+                emptyCount++;
+                continue;
+            }
+            if (emptyCount) {
+                *out++ = (char)('0' + emptyCount);
+                emptyCount = 0;
+            }
+            char pieceChar = notation[tagPiece(tag)];
+            *out++ = tagColor(tag) == White ? (char)toupper(pieceChar) : pieceChar;
+        }
+        if (emptyCount) {
+            *out++ = (char)('0' + emptyCount);
+        }
+        if (y > 0) {
+            *out++ = '/';
+        }
+    }
+
+    // field 1 | turn
+    *out++ = ' ';
+    *out++ = sideToMove == White ? 'w' : 'b';
+
+    // field 2 | castling
+    *out++ = ' ';
+    if (castling == NoCastling) {
+        *out++ = '-';
+    }
+    if (castling & WhiteKingSide) *out++ = 'K';
+    if (castling & WhiteQueenSide) *out++ = 'Q';
+    if (castling & BlackKingSide) *out++ = 'k';
+    if (castling & BlackQueenSide) *out++ = 'q';
+
+    // field 3 | en passant
+    *out++ = ' ';
+    if (enPassant == NoSquare) {
+        *out++ = '-';
+    } else {
+        *out++ = (char)('a' + enPassant % 8);
+        *out++ = (char)('1' + enPassant / 8);
+    }
+
+    // field 4 and 5 | clocks
+    out += snprintf(out, 16, " %d %d", halfmoveClock, fullmoveNumber);
+    return (int)(out - buffer);
+}
+
+#pragma region Make / Unmake
+
+// castling rights that survive a move touching each square; the king and rook home squares clear theirs
+static const uint8_t castlingRightsKept[64] = {
+    AllCastling & ~WhiteQueenSide, AllCastling, AllCastling, AllCastling,
+    AllCastling & ~(WhiteKingSide | WhiteQueenSide), AllCastling, AllCastling, AllCastling & ~WhiteKingSide,
+    AllCastling, AllCastling, AllCastling, AllCastling, AllCastling, AllCastling, AllCastling, AllCastling,
+    AllCastling, AllCastling, AllCastling, AllCastling, AllCastling, AllCastling, AllCastling, AllCastling,
+    AllCastling, AllCastling, AllCastling, AllCastling, AllCastling, AllCastling, AllCastling, AllCastling,
+    AllCastling, AllCastling, AllCastling, AllCastling, AllCastling, AllCastling, AllCastling, AllCastling,
+    AllCastling, AllCastling, AllCastling, AllCastling, AllCastling, AllCastling, AllCastling, AllCastling,
+    AllCastling, AllCastling, AllCastling, AllCastling, AllCastling, AllCastling, AllCastling, AllCastling,
+    AllCastling & ~BlackQueenSide, AllCastling, AllCastling, AllCastling,
+    AllCastling & ~(BlackKingSide | BlackQueenSide), AllCastling, AllCastling, AllCastling & ~BlackKingSide
+};
+
+void Position::makeMove(BitMove move)
+{
+    UndoInfo& undo = undoStack.emplace_back();
+    undo.key = key;
+    undo.move = move;
+    undo.captured = 0;
+    undo.castling = castling;
+    undo.enPassant = enPassant;
+    undo.halfmoveClock = halfmoveClock;
+
+    int us = sideToMove;
+    int from = move.from();
+    int to = move.to();
+    ChessPiece moved = tagPiece(board[from]);
+    int capturedSquare = to;
+
+    halfmoveClock++;
+    if (move.flags() == EnPassantCapture) {
+        // the captured pawn sits behind the target square
+        capturedSquare = to + (us == White ? -8 : 8);
+        undo.captured = board[capturedSquare];
+        removePiece(capturedSquare);
+    } else if (board[to]) {
+        undo.captured = board[to];
+        removePiece(to);
+    }
+    if (undo.captured || moved == Pawn) {
+        halfmoveClock = 0;
+    }
+
+    movePiece(from, to);
+    if (move.isPromotion()) {
+        removePiece(to);
+        putPiece(us, move.promotionPiece(), to);
+    } else if (move.flags() == KingCastle) {
+        movePiece(to + 1, to - 1);
+    } else if (move.flags() == QueenCastle) {
+        movePiece(to - 2, to + 1);
+    }
+
+    if (enPassant != NoSquare) {
+        key ^= Zobrist.enPassantFile[enPassant % 8];
+    }
+    enPassant = NoSquare;
+    if (move.flags() == DoublePawnPush) {
+        enPassant = (from + to) / 2;
+        key ^= Zobrist.enPassantFile[enPassant % 8];
+    }
+    key ^= Zobrist.castling[castling];
+    castling &= castlingRightsKept[from] & castlingRightsKept[to];
+    key ^= Zobrist.castling[castling];
+    if (us == Black) {
+        fullmoveNumber++;
+    }
+    sideToMove = us ^ 1;
+    key ^= Zobrist.blackToMove;
+
+    if (accumulators.empty()) {
+        return;
+    }
+    // copy the last accumulator and move the pieces that changed in it; unmake just drops it again
+    accumulators.push_back(accumulators.back());
+    NnueAccumulator& accumulator = accumulators.back();
+    for (int perspective = White; perspective <= Black; perspective++) {
+        int16_t* half = accumulator.values[perspective];
+        // our king moving changes every input we see, the other king isn't an input at all
+        if (moved == King && perspective == us) {
+            refreshAccumulator(perspective);
+            continue;
+        }
+        int king = kingSquare(perspective);
+        if (moved != King) {
+            nnueSubFeature(half, nnueFeatureIndex(perspective, king, us, moved, from));
+            nnueAddFeature(half, nnueFeatureIndex(perspective, king, us, move.isPromotion() ? move.promotionPiece() : moved, to));
+        }
+        if (undo.captured) {
+            nnueSubFeature(half, nnueFeatureIndex(perspective, king, us ^ 1, tagPiece(undo.captured), capturedSquare));
+        }
+        if (move.isCastle()) {
+            int rookFrom = move.flags() == KingCastle ? to + 1 : to - 2;
+            int rookTo = move.flags() == KingCastle ? to - 1 : to + 1;
+            nnueSubFeature(half, nnueFeatureIndex(perspective, king, us, Rook, rookFrom));
+            nnueAddFeature(half, nnueFeatureIndex(perspective, king, us, Rook, rookTo));
+        }
+    }
+}
+
+void Position::unmakeMove()
+{
+    const UndoInfo undo = undoStack.back();
+    undoStack.pop_back();
+    if (!accumulators.empty()) {
+        accumulators.pop_back();
+    }
+
+    BitMove move = undo.move;
+    int us = sideToMove ^ 1;
+    int from = move.from();
+    int to = move.to();
+
+    sideToMove = us;
+    if (us == Black) {
+        fullmoveNumber--;
+    }
+
+    if (move.isPromotion()) {
+        removePiece(to);
+        putPiece(us, Pawn, to);
+    } else if (move.flags() == KingCastle) {
+        movePiece(to - 1, to + 1);
+    } else if (move.flags() == QueenCastle) {
+        movePiece(to + 1, to - 2);
+    }
+    movePiece(to, from);
+
+    if (undo.captured) {
+        int capturedSquare = move.flags() == EnPassantCapture ? to + (us == White ? -8 : 8) : to;
+        putPiece(tagColor(undo.captured), tagPiece(undo.captured), capturedSquare);
+    }
+
+    castling = undo.castling;
+    enPassant = undo.enPassant;
+    halfmoveClock = undo.halfmoveClock;
+    // the piece moves above xor'd the key back piece by piece; just take the saved one for the rest
+    key = undo.key;
+}
+
+// only with both kings on the board, since every input is relative to one of them
+void Position::resetAccumulators()
+{
+    accumulators.clear();
+    if (!nnueNetwork() || std::popcount(pieces[White][King]) != 1 || std::popcount(pieces[Black][King]) != 1) {
+        return;
+    }
+    accumulators.emplace_back();
+    refreshAccumulator(White);
+    refreshAccumulator(Black);
+}
+
+void Position::refreshAccumulator(int perspective)
+{
+    int16_t* half = accumulators.back().values[perspective];
+    int king = kingSquare(perspective);
+    nnueResetHalf(half);
+    for (int color = White; color <= Black; color++) {
+        for (int piece = Pawn; piece < King; piece++) {
+            for (uint64_t bits = pieces[color][piece]; bits; bits &= bits - 1) {
+                nnueAddFeature(half, nnueFeatureIndex(perspective, king, color, piece, std::countr_zero(bits)));
+            }
+        }
+    }
+}
+
+// pass the move to the other side. the clock restarts so repetition checks never reach back across it
+void Position::makeNullMove()
+{
+    UndoInfo& undo = undoStack.emplace_back();
+    undo.key = key;
+    undo.move = BitMove{};
+    undo.captured = 0;
+    undo.castling = castling;
+    undo.enPassant = enPassant;
+    undo.halfmoveClock = halfmoveClock;
+
+    halfmoveClock = 0;
+    if (enPassant != NoSquare) {
+        key ^= Zobrist.enPassantFile[enPassant % 8];
+        enPassant = NoSquare;
+    }
+    sideToMove ^= 1;
+    key ^= Zobrist.blackToMove;
+}
+
+void Position::unmakeNullMove()
+{
+    const UndoInfo undo = undoStack.back();
+    undoStack.pop_back();
+
+    sideToMove ^= 1;
+    enPassant = undo.enPassant;
+    halfmoveClock = undo.halfmoveClock;
+    key = undo.key;
+}
+
+#pragma endregion
+
+#pragma region Chess Piece Movement
+
+//
+// legal moves only. checkers, pins and the squares the king can't step onto are worked out once,
+// then each piece generator is handed just the squares it may move to:
+// - in double check only the king can move
+// - in single check everything else must capture the checker or block its line
+// - a pinned piece can only move along the line between its king and the pinner
+// captures or quiets alone just narrow those squares down to enemy pieces or empty ones
+//
+template <SliderBackend Backend>
+void Position::generateMoves(MoveList& moves, MoveGenType type) const
+{
+    int us = sideToMove;
+    int them = us ^ 1;
+    int kingPos = kingSquare(us);
+    uint64_t ours = colorOccupancy(us);
+    uint64_t theirs = colorOccupancy(them);
+
+    uint64_t checkers = 0ULL;
+    uint64_t pinned = 0ULL;
+    uint64_t kingDanger = 0ULL;
+    if (kingPos != NoSquare) {
+        // take the king off the board so it can't hide from a slider behind its own square
+        kingDanger = attackedSquares<Backend>(them, occupancy ^ (1ULL << kingPos));
+        checkers = attackersTo<Backend>(kingPos, occupancy) & theirs;
+        pinned = pinnedPieces<Backend>(us);
+    }
+
+    uint64_t typeMask = type == GenCaptures ? theirs : type == GenQuiets ? ~occupancy : ~0ULL;
+    generateKingMoves(moves, kingPos, ~ours & ~kingDanger & typeMask);
+    if (checkers & (checkers - 1)) {
+        return;
+    }
+
+    uint64_t checkMask = ~0ULL;
+    if (checkers) {
+        checkMask = checkers | SquaresBetween[kingPos][std::countr_zero(checkers)];
+    } else if (type != GenCaptures) {
+        generateCastlingMoves(moves, kingPos, kingDanger);
+    }
+    uint64_t targets = ~ours & checkMask & typeMask;
+
+    generateKnightMoves(moves, piecesOf(us, Knight) & ~pinned, targets);
+    generatePawnMoves(moves, piecesOf(us, Pawn) & ~pinned, ~occupancy, theirs, us, checkMask, type);
+    generateBishopMoves<Backend>(moves, piecesOf(us, Bishop) & ~pinned, targets);
+    generateRookMoves<Backend>(moves, piecesOf(us, Rook) & ~pinned, targets);
+    generateQueenMoves<Backend>(moves, piecesOf(us, Queen) & ~pinned, targets);
+
+    // a pinned knight never has a move, the rest stay on the pin line
+    BitBoard(pinned & ~piecesOf(us, Knight)).forEachBit([&](int square) {
+        uint64_t pinLine = LineThrough[kingPos][square];
+        uint64_t pieceBit = 1ULL << square;
+        switch (tagPiece(board[square])) {
+            case Pawn:
+                generatePawnMoves(moves, pieceBit, ~occupancy, theirs, us, checkMask & pinLine, type);
+                break;
+            case Bishop:
+                generateBishopMoves<Backend>(moves, pieceBit, targets & pinLine);
+                break;
+            case Rook:
+                generateRookMoves<Backend>(moves, pieceBit, targets & pinLine);
+                break;
+            case Queen:
+                generateQueenMoves<Backend>(moves, pieceBit, targets & pinLine);
+                break;
+            default:
+                break;
+        }
+    });
+
+    if (type != GenQuiets) {
+        generateEnPassantMoves<Backend>(moves, piecesOf(us, Pawn), kingPos, checkers);
+    }
+}
+
+template <SliderBackend Backend>
+uint64_t Position::attackersTo(int square, uint64_t occupied) const
+{
+    uint64_t bishopsQueens = pieces[White][Bishop] | pieces[Black][Bishop] | pieces[White][Queen] | pieces[Black][Queen];
+    uint64_t rooksQueens = pieces[White][Rook] | pieces[Black][Rook] | pieces[White][Queen] | pieces[Black][Queen];
+    return (PawnAttacks[Black][square] & pieces[White][Pawn])
+         | (PawnAttacks[White][square] & pieces[Black][Pawn])
+         | (KnightAttacks[square] & (pieces[White][Knight] | pieces[Black][Knight]))
+         | (KingAttacks[square] & (pieces[White][King] | pieces[Black][King]))
+         | (getBishopAttacks<Backend>(square, occupied) & bishopsQueens)
+         | (getRookAttacks<Backend>(square, occupied) & rooksQueens);
+}
+
+template <SliderBackend Backend>
+uint64_t Position::attackedSquares(int byColor, uint64_t occupied) const
+{
+    constexpr uint64_t NotCol1(0xFEFEFEFEFEFEFEFEULL);
+    constexpr uint64_t NotCol8(0x7F7F7F7F7F7F7F7FULL);
+
+    uint64_t pawns = pieces[byColor][Pawn];
+    uint64_t attacked = byColor == White ?
+        ((pawns & NotCol1) << 7) | ((pawns & NotCol8) << 9) :
+        ((pawns & NotCol1) >> 9) | ((pawns & NotCol8) >> 7);
+
+    BitBoard(pieces[byColor][Knight]).forEachBit([&](int square) {
+        attacked |= KnightAttacks[square];
+    });
+    BitBoard(pieces[byColor][King]).forEachBit([&](int square) {
+        attacked |= KingAttacks[square];
+    });
+    BitBoard(pieces[byColor][Bishop] | pieces[byColor][Queen]).forEachBit([&](int square) {
+        attacked |= getBishopAttacks<Backend>(square, occupied);
+    });
+    BitBoard(pieces[byColor][Rook] | pieces[byColor][Queen]).forEachBit([&](int square) {
+        attacked |= getRookAttacks<Backend>(square, occupied);
+    });
+    return attacked;
+}
+
+template <SliderBackend Backend>
+uint64_t Position::pinnedPieces(int color) const
+{
+    int kingPos = kingSquare(color);
+    if (kingPos == NoSquare) {
+        return 0ULL;
+    }
+    int them = color ^ 1;
+    uint64_t queens = pieces[them][Queen];
+    // enemy sliders that would hit the king on an empty board
+    uint64_t snipers = (getRookAttacks<Backend>(kingPos, 0ULL) & (pieces[them][Rook] | queens))
+                     | (getBishopAttacks<Backend>(kingPos, 0ULL) & (pieces[them][Bishop] | queens));
+
+    uint64_t pinned = 0ULL;
+    BitBoard(snipers).forEachBit([&](int square) {
+        uint64_t between = SquaresBetween[kingPos][square] & occupancy;
+        if (between && !(between & (between - 1))) {
+            pinned |= between & pieces[color][NoPiece];
+        }
+    });
+    return pinned;
+}
+
+//
+// swap off the exchange on the target square without making any moves. swap is what the side that just
+// captured stands to lose if the other side takes back, relative to threshold; each side only keeps
+// capturing while that's worth it, and sliders behind the piece that just left join in as x-rays.
+// pins are ignored, so a pinned piece can still take part
+//
+template <SliderBackend Backend>
+bool Position::see(BitMove move, int threshold) const
+{
+    if (move.isCastle()) {
+        return threshold <= 0;
+    }
+    int from = move.from();
+    int to = move.to();
+    int captured = move.flags() == EnPassantCapture ? Pawn : tagPiece(board[to]);
+    int moved = movedPiece(move);
+    int swap = SeeValues[captured] - threshold;
+    if (move.isPromotion()) {
+        swap += SeeValues[move.promotionPiece()] - SeeValues[Pawn];
+        moved = move.promotionPiece();
+    }
+    if (swap < 0) {
+        return false;
+    }
+    // even losing the piece we moved leaves us above threshold
+    swap = SeeValues[moved] - swap;
+    if (swap <= 0) {
+        return true;
+    }
+
+    uint64_t occupied = occupancy ^ (1ULL << from) ^ (1ULL << to);
+    if (move.flags() == EnPassantCapture) {
+        occupied ^= 1ULL << (to + (sideToMove == White ? -8 : 8));
+    }
+    uint64_t bishopsQueens = pieces[White][Bishop] | pieces[Black][Bishop] | pieces[White][Queen] | pieces[Black][Queen];
+    uint64_t rooksQueens = pieces[White][Rook] | pieces[Black][Rook] | pieces[White][Queen] | pieces[Black][Queen];
+    uint64_t attackers = attackersTo<Backend>(to, occupied);
+    int stm = sideToMove;
+    bool result = true;
+
+    while (true) {
+        stm ^= 1;
+        attackers &= occupied;
+        uint64_t stmAttackers = attackers & colorOccupancy(stm);
+        if (!stmAttackers) {
+            break;
+        }
+        result = !result;
+
+        int piece = Pawn;
+        while (!(stmAttackers & pieces[stm][piece])) {
+            piece++;
+        }
+        // the king can only take back if nothing is left to take it
+        if (piece == King) {
+            return (attackers & colorOccupancy(stm ^ 1)) ? !result : result;
+        }
+        swap = SeeValues[piece] - swap;
+        if (swap < (int)result) {
+            break;
+        }
+        uint64_t attackerBits = stmAttackers & pieces[stm][piece];
+        occupied ^= attackerBits & (0 - attackerBits);
+        if (piece == Pawn || piece == Bishop || piece == Queen) {
+            attackers |= getBishopAttacks<Backend>(to, occupied) & bishopsQueens;
+        }
+        if (piece == Rook || piece == Queen) {
+            attackers |= getRookAttacks<Backend>(to, occupied) & rooksQueens;
+        }
+    }
+    return result;
+}
+
+//
+// the move has to be one generateMoves would produce here: our piece on from, the flags matching
+// what's actually on the board, a square the piece can reach, and our king safe afterwards
+//
+template <SliderBackend Backend>
+bool Position::isLegal(BitMove move) const
+{
+    int us = sideToMove;
+    int them = us ^ 1;
+    int from = move.from();
+    int to = move.to();
+    int flags = move.flags();
+    uint8_t tag = board[from];
+    uint64_t fromBit = 1ULL << from;
+    uint64_t toBit = 1ULL << to;
+
+    if (move.isNone() || !tag || tagColor(tag) != us || (colorOccupancy(us) & toBit) || flags == 6 || flags == 7) {
+        return false;
+    }
+    ChessPiece piece = tagPiece(tag);
+    int kingPos = kingSquare(us);
+    uint64_t checkers = kingPos != NoSquare ? attackersTo<Backend>(kingPos, occupancy) & colorOccupancy(them) : 0ULL;
+
+    // the rare ones just get generated and looked for
+    if (move.isCastle() || flags == EnPassantCapture) {
+        MoveList special;
+        if (move.isCastle() && piece == King && !checkers) {
+            generateCastlingMoves(special, kingPos, attackedSquares<Backend>(them, occupancy ^ fromBit));
+        } else if (flags == EnPassantCapture && piece == Pawn) {
+            generateEnPassantMoves<Backend>(special, fromBit, kingPos, checkers);
+        }
+        return special.contains(move);
+    }
+    if (move.isCapture() != (board[to] != 0)) {
+        return false;
+    }
+
+    if (piece == Pawn) {
+        int forward = us == White ? 8 : -8;
+        if (move.isPromotion() != (to / 8 == (us == White ? 7 : 0))) {
+            return false;
+        }
+        if (move.isCapture()) {
+            if (!(PawnAttacks[us][from] & toBit)) {
+                return false;
+            }
+        } else if (flags == DoublePawnPush) {
+            if (from / 8 != (us == White ? 1 : 6) || to != from + 2 * forward || board[from + forward]) {
+                return false;
+            }
+        } else if (to != from + forward) {
+            return false;
+        }
+    } else {
+        if (flags != QuietMove && flags != CaptureMove) {
+            return false;
+        }
+        uint64_t reach = piece == Knight ? KnightAttacks[from]
+                       : piece == King ? KingAttacks[from]
+                       : piece == Bishop ? getBishopAttacks<Backend>(from, occupancy)
+                       : piece == Rook ? getRookAttacks<Backend>(from, occupancy)
+                       : getQueenAttacks<Backend>(from, occupancy);
+        if (!(reach & toBit)) {
+            return false;
+        }
+    }
+
+    if (kingPos == NoSquare) {
+        return true;
+    }
+    if (piece == King) {
+        // look from the target with the king already gone from its square, ignoring whatever it takes there
+        return !(attackersTo<Backend>(to, occupancy ^ fromBit) & colorOccupancy(them) & ~toBit);
+    }
+    if (checkers) {
+        if (checkers & (checkers - 1)) {
+            return false;
+        }
+        if (!((checkers | SquaresBetween[kingPos][std::countr_zero(checkers)]) & toBit)) {
+            return false;
+        }
+    }
+    return !(pinnedPieces<Backend>(us) & fromBit) || (LineThrough[kingPos][from] & toBit);
+}
+
+#pragma region Knight FX
+
+void Position::generateKnightMoves(MoveList& moves, BitBoard knightBoard, uint64_t empty_squares) const {
+    knightBoard.forEachBit([&](int fromSquare) {
+        BitBoard moveBitboard = BitBoard(KnightAttacks[fromSquare] & empty_squares);
+        // Efficiently iterate through only the set bits
+        moveBitboard.forEachBit([&](int toSquare) {
+           moves.emplace_back(fromSquare, toSquare, captureFlag(toSquare));
+        });
+    });
+}
+
+#pragma endregion
+
+#pragma region King FX
+
+void Position::generateKingMoves(MoveList& moves, int kingPos, uint64_t empty_squares) const {
+    if (kingPos == NoSquare) { // no king, so return
+        return;
+    }
+    BitBoard moveBitboard = BitBoard(KingAttacks[kingPos] & empty_squares);
+    // Efficiently iterate through only the set bits
+    moveBitboard.forEachBit([&](int toSquare) {
+        moves.emplace_back(kingPos, toSquare, captureFlag(toSquare));
+    });
+}
+
+//
+// the king and rook must be unmoved (castling rights), the squares between them empty,
+// and the king may not start on, pass through or land on an attacked square
+//
+void Position::generateCastlingMoves(MoveList& moves, int kingPos, uint64_t kingDanger) const {
+    int us = sideToMove;
+    uint8_t kingSide = us == White ? WhiteKingSide : BlackKingSide;
+    uint8_t queenSide = us == White ? WhiteQueenSide : BlackQueenSide;
+    if (!(castling & (kingSide | queenSide)) || kingPos != (us == White ? 4 : 60)) {
+        return;
+    }
+    if (kingDanger & (1ULL << kingPos)) {
+        return;
+    }
+    uint64_t kingSideBetween = 0x60ULL << (us == White ? 0 : 56);    // f and g
+    uint64_t queenSideBetween = 0x0EULL << (us == White ? 0 : 56);   // b, c and d
+    uint64_t queenSidePath = 0x0CULL << (us == White ? 0 : 56);      // c and d, the king never crosses b
+    // setFEN drops rights without a rook at home, but a position built piece by piece may still have them
+    uint64_t rooks = pieces[us][Rook];
+    if ((castling & kingSide) && (rooks & (1ULL << (kingPos + 3)))
+        && !(occupancy & kingSideBetween) && !(kingDanger & kingSideBetween)) {
+        moves.emplace_back(kingPos, kingPos + 2, KingCastle);
+    }
+    if ((castling & queenSide) && (rooks & (1ULL << (kingPos - 4)))
+        && !(occupancy & queenSideBetween) && !(kingDanger & queenSidePath)) {
+        moves.emplace_back(kingPos, kingPos - 2, QueenCastle);
+    }
+}
+
+#pragma endregion
+
+#pragma region Sliding FX
+
+template <SliderBackend Backend>
+void Position::generateBishopMoves(MoveList& moves, BitBoard bishopBoard, uint64_t empty_squares) const {
+    bishopBoard.forEachBit([&](int fromSquare) {
+        BitBoard moveBitboard = BitBoard(getBishopAttacks<Backend>(fromSquare, occupancy) & empty_squares);
+        moveBitboard.forEachBit([&](int toSquare) {
+           moves.emplace_back(fromSquare, toSquare, captureFlag(toSquare));
+        });
+    });
+}
+
+template <SliderBackend Backend>
+void Position::generateRookMoves(MoveList& moves, BitBoard rookBoard, uint64_t empty_squares) const {
+    rookBoard.forEachBit([&](int fromSquare) {
+        BitBoard moveBitboard = BitBoard(getRookAttacks<Backend>(fromSquare, occupancy) & empty_squares);
+        moveBitboard.forEachBit([&](int toSquare) {
+           moves.emplace_back(fromSquare, toSquare, captureFlag(toSquare));
+        });
+    });
+}
+
+template <SliderBackend Backend>
+void Position::generateQueenMoves(MoveList& moves, BitBoard queenBoard, uint64_t empty_squares) const {
+    queenBoard.forEachBit([&](int fromSquare) {
+        BitBoard moveBitboard = BitBoard(getQueenAttacks<Backend>(fromSquare, occupancy) & empty_squares);
+        moveBitboard.forEachBit([&](int toSquare) {
+           moves.emplace_back(fromSquare, toSquare, captureFlag(toSquare));
+        });
+    });
+}
+
+#pragma endregion
+
+#pragma region Pawn FX
+
+void Position::generatePawnMoves(MoveList& moves, BitBoard pawnBoard, uint64_t empty_squares,
+     uint64_t enemyPieces, int color, uint64_t targets, MoveGenType type) const {
+    if (pawnBoard.getData() == 0) {  // no pawns
+        return;
+    }
+
+    // define row & column masks for specific pawn cases
+    constexpr uint64_t NotCol1(0xFEFEFEFEFEFEFEFEULL);  // mask along the first column
+    constexpr uint64_t NotCol8(0x7F7F7F7F7F7F7F7FULL);  // mask along the last column
+    constexpr uint64_t Row3(0x0000000000FF0000ULL);     // mask on the 3rd row
+    constexpr uint64_t Row6(0x0000FF0000000000ULL);     // mask on the 6th row
+
+    // Calculate single moves
+    // shift bits LEFT to push white up the board. otherwise, shift bits RIGHT to push black down the board
+    BitBoard singleMoves = color == White ?
+    (pawnBoard.getData() << 8) & empty_squares:
+    (pawnBoard.getData() >> 8) & empty_squares;
+
+    // Calculate double moves
+    /*only let pawns move forward if:
+    - (after a single move) pawns are on row 3 for white, row 6 for black
+    - after a single move, the next square is empty
+    */
+    BitBoard doubleMoves = color == White ?
+    ((singleMoves.getData() & Row3) << 8) & empty_squares:
+    ((singleMoves.getData() & Row6) >> 8) & empty_squares;
+
+    // Calculate left & right capturing
+    // can only capture when an enemy piece is present
+    // check left column. Ignore for pawns on column 1
+    BitBoard captureLeft = color == White ?
+    ((pawnBoard.getData() & NotCol1) << 7) & enemyPieces:
+    ((pawnBoard.getData() & NotCol1) >> 9) & enemyPieces;
+    // check right column. Ignore for pawns on column 8
+    BitBoard captureRight = color == White ?
+    ((pawnBoard.getData() & NotCol8) << 9) & enemyPieces:
+    ((pawnBoard.getData() & NotCol8) >> 7) & enemyPieces;
+
+    // the double push needs the single push square empty even when it isn't a target itself
+    singleMoves = singleMoves.getData() & targets;
+    doubleMoves = doubleMoves.getData() & targets;
+    captureLeft = captureLeft.getData() & targets;
+    captureRight = captureRight.getData() & targets;
+
+    int shiftForward = (color == White) ? 8 : -8;
+    int doubleShift = (color == White) ? 16 : -16;
+    int captureLeftShift = (color == White) ? 7 : -9;
+    int captureRightShift = (color == White) ? 9 : -7;
+
+    // anything reaching the far row promotes instead
+    uint64_t promotionRow = color == White ? 0xFF00000000000000ULL : 0x00000000000000FFULL;
+
+    // promotions count as captures, whatever they land on
+    if (type != GenCaptures) {
+        // add single and double moves to list
+        addPawnBitBoardMoves(moves, singleMoves.getData() & ~promotionRow, shiftForward, QuietMove);
+        addPawnBitBoardMoves(moves, doubleMoves, doubleShift, DoublePawnPush);
+    }
+    if (type != GenQuiets) {
+        addPawnPromotions(moves, singleMoves.getData() & promotionRow, shiftForward, QuietMove);
+        // add left captures to list
+        addPawnBitBoardMoves(moves, captureLeft.getData() & ~promotionRow, captureLeftShift, CaptureMove);
+        addPawnPromotions(moves, captureLeft.getData() & promotionRow, captureLeftShift, CaptureMove);
+        // add right captures to list
+        addPawnBitBoardMoves(moves, captureRight.getData() & ~promotionRow, captureRightShift, CaptureMove);
+        addPawnPromotions(moves, captureRight.getData() & promotionRow, captureRightShift, CaptureMove);
+    }
+}
+
+//
+// en passant is the one move that takes two pieces off the same rank at once, which can uncover a
+// slider on our king that no pin mask sees. just lift both pawns and look along the lines from the king
+//
+template <SliderBackend Backend>
+void Position::generateEnPassantMoves(MoveList& moves, BitBoard pawnBoard, int kingPos, uint64_t checkers) const {
+    if (enPassant == NoSquare) {
+        return;
+    }
+    int us = sideToMove;
+    int them = us ^ 1;
+    int capturedSquare = enPassant + (us == White ? -8 : 8);
+    // a knight or pawn check can only be answered here by taking the checking pawn
+    if (checkers & ~(1ULL << capturedSquare) & (pieces[them][Knight] | pieces[them][Pawn])) {
+        return;
+    }
+
+    uint64_t bishopsQueens = pieces[them][Bishop] | pieces[them][Queen];
+    uint64_t rooksQueens = pieces[them][Rook] | pieces[them][Queen];
+    BitBoard enPassantPawns = PawnAttacks[them][enPassant] & pawnBoard.getData();
+    enPassantPawns.forEachBit([&](int fromSquare) {
+        if (kingPos != NoSquare) {
+            uint64_t after = (occupancy ^ (1ULL << fromSquare) ^ (1ULL << capturedSquare)) | (1ULL << enPassant);
+            if ((getBishopAttacks<Backend>(kingPos, after) & bishopsQueens) || (getRookAttacks<Backend>(kingPos, after) & rooksQueens)) {
+                return;
+            }
+        }
+        moves.emplace_back(fromSquare, enPassant, EnPassantCapture);
+    });
+}
+
+void Position::addPawnBitBoardMoves(MoveList& moves, const BitBoard pawnMove, const int shift, int flags) const {
+    pawnMove.forEachBit([&](int toSquare) {
+        int fromSquare = toSquare - shift;
+        moves.emplace_back(fromSquare, toSquare, flags);
+    });
+}
+
+void Position::addPawnPromotions(MoveList& moves, const BitBoard pawnMove, const int shift, int flags) const {
+    pawnMove.forEachBit([&](int toSquare) {
+        int fromSquare = toSquare - shift;
+        moves.emplace_back(fromSquare, toSquare, flags | QueenPromotion);
+        moves.emplace_back(fromSquare, toSquare, flags | KnightPromotion);
+        moves.emplace_back(fromSquare, toSquare, flags | RookPromotion);
+        moves.emplace_back(fromSquare, toSquare, flags | BishopPromotion);
+    });
+}
+
+#pragma endregion
+
+#pragma endregion
+
+#pragma region Backend Dispatch
+
+bool Position::inCheck() const
+{
+    return SliderBackendInUse == SliderPext ? inCheck<SliderPext>() : inCheck<SliderMagic>();
+}
+
+void Position::generateMoves(MoveList& moves, MoveGenType type) const
+{
+    if (SliderBackendInUse == SliderPext) {
+        generateMoves<SliderPext>(moves, type);
+    } else {
+        generateMoves<SliderMagic>(moves, type);
+    }
+}
+
+bool Position::isLegal(BitMove move) const
+{
+    return SliderBackendInUse == SliderPext ? isLegal<SliderPext>(move) : isLegal<SliderMagic>(move);
+}
+
+// what the search and perft call from their own translation units
+template bool Position::isSquareAttacked<SliderMagic>(int square, int byColor) const;
+template bool Position::isSquareAttacked<SliderPext>(int square, int byColor) const;
+template void Position::generateMoves<SliderMagic>(MoveList& moves, MoveGenType type) const;
+template void Position::generateMoves<SliderPext>(MoveList& moves, MoveGenType type) const;
+template bool Position::isLegal<SliderMagic>(BitMove move) const;
+template bool Position::isLegal<SliderPext>(BitMove move) const;
+template bool Position::see<SliderMagic>(BitMove move, int threshold) const;
+template bool Position::see<SliderPext>(BitMove move, int threshold) const;
+
+#pragma endregion
@@ -0,0 +1,171 @@
+#pragma once
+
+#include "Bitboard.h"
+#include "MoveList.h"
+#include "Nnue.h"
+#include "PieceSquare.h"
+#include "Zobrist.h"
+#include <string>
+#include <string_view>
+#include <vector>
+
+// player numbers, white is player 0
+enum ChessColor
+{
+    White,
+    Black
+};
+
+enum CastlingRights
+{
+    NoCastling     = 0,
+    WhiteKingSide  = 1,
+    WhiteQueenSide = 2,
+    BlackKingSide  = 4,
+    BlackQueenSide = 8,
+    AllCastling    = 15
+};
+
+constexpr int NoSquare = 64;
+
+// longest FEN toFEN can write, with its terminator: 64 board characters + 7 slashes + the other fields
+constexpr int MaxFENLength = 92;
+
+// pieces on the board use the same tags as the Bit sprites: the piece type, plus 128 for black
+constexpr uint8_t pieceTag(int color, ChessPiece piece) { return (uint8_t)(piece | (color << 7)); }
+constexpr ChessPiece tagPiece(uint8_t tag) { return (ChessPiece)(tag & 7); }
+constexpr int tagColor(uint8_t tag) { return tag >> 7; }
+// where a piece's count sits in Position::materialKey, four bits for every color and piece
+constexpr int materialKeyShift(int color, int piece) { return (color * 8 + piece) * 4; }
+
+// piece values for exchanges and capture ordering, in centipawns
+extern const int SeeValues[7];
+
+// which moves a generator call produces; captures includes every promotion and quiets everything else
+enum MoveGenType
+{
+    GenAll,
+    GenCaptures,
+    GenQuiets
+};
+
+// everything makeMove overwrites that unmakeMove can't work out from the move itself
+struct UndoInfo
+{
+    uint64_t    key;
+    BitMove     move;
+    uint8_t     captured;           // piece tag taken by the move, 0 if none
+    uint8_t     castling;
+    uint8_t     enPassant;
+    uint8_t     halfmoveClock;
+};
+
+//
+// the chess position as bitboards
+// this is the source of truth for the game; the grid sprites only mirror it.
+// laid out so the bitboards used by move generation share the first two cache lines
+//
+struct alignas(64) Position
+{
+    uint64_t    pieces[2][7];       // [color][ChessPiece], slot 0 (NoPiece) holds every piece of that color
+    uint64_t    occupancy;          // both colors
+    uint64_t    key;                // zobrist hash, kept up to date by every change below
+    uint8_t     sideToMove;         // ChessColor
+    uint8_t     castling;           // CastlingRights bits
+    uint8_t     enPassant;          // square a pawn can capture onto en passant, NoSquare if none
+    uint8_t     halfmoveClock;      // plies since the last capture or pawn move
+    uint16_t    fullmoveNumber;
+    uint8_t     board[64];          // piece tag on each square, 0 for empty
+    // piece-square totals, white minus black; kept up to date like key
+    int16_t     midgameScore;
+    int16_t     endgameScore;
+    uint64_t    materialKey;        // how many of each piece there are, see materialKeyShift
+    uint64_t    pawnKey;            // zobrist hash of just the pawns, for the pawn structure cache
+
+    std::vector<UndoInfo> undoStack;    // one entry per move made since the position was set up
+    // one nnue accumulator per move made, the back one for the position as it stands.
+    // empty unless a network was loaded when the position was set up
+    std::vector<NnueAccumulator> accumulators;
+
+    void clear();
+    // read a FEN into the position; false if the board part doesn't fill exactly 8x8 squares or
+    // doesn't have one king a side. castling rights without their king and rook at home are dropped.
+    // allocates nothing, so tools can stream through big position files with it
+    bool setFEN(std::string_view fen);
+    // write the position as a null terminated FEN into buffer, which needs MaxFENLength bytes; returns the length
+    int toFEN(char* buffer) const;
+    void putPiece(int color, ChessPiece piece, int square);
+    void removePiece(int square);
+    void movePiece(int from, int to);
+    // hash the whole position from scratch; set up code uses this once the fields are filled in
+    uint64_t computeKey() const;
+
+    // play a move from generateAllMoves and take it back again, without touching any sprites
+    void makeMove(BitMove move);
+    void unmakeMove();
+    // start the accumulator stack over from the pieces on the board, or leave it empty without a network
+    void resetAccumulators();
+    // work out one side's half of the current accumulator from scratch
+    void refreshAccumulator(int perspective);
+    // let the other side move twice in a row, for null move pruning; the undo entry holds an empty move
+    void makeNullMove();
+    void unmakeNullMove();
+
+    // the position has been seen before since the last capture or pawn move
+    bool isRepetition() const;
+    // how many times the position has been seen before since the last capture or pawn move
+    int repetitionCount() const;
+    // drawn by repetition or the fifty move rule, whatever the moves are. the search calls any repeat
+    // a draw, since if it was worth repeating once it's worth repeating again
+    bool isDrawByRule() const { return halfmoveClock >= 100 || isRepetition(); }
+    // the rules of the game itself: threefold repetition or fifty moves without a capture or pawn move
+    bool isDrawByGameRule() const { return halfmoveClock >= 100 || repetitionCount() >= 2; }
+
+    // everything that looks up slider attacks is templated on the slider backend. perft and the search
+    // pick it once at the top and stay on it; the plain versions further down are for everything else
+    // and check SliderBackendInUse on each call
+
+    // is the square attacked by any piece of byColor
+    template <SliderBackend Backend> bool isSquareAttacked(int square, int byColor) const;
+    // every piece of either color attacking the square, with the given pieces in the way
+    template <SliderBackend Backend> uint64_t attackersTo(int square, uint64_t occupied) const;
+    // every square a piece of byColor attacks, with the given pieces in the way
+    template <SliderBackend Backend> uint64_t attackedSquares(int byColor, uint64_t occupied) const;
+    // our pieces standing alone between our king and an enemy slider
+    template <SliderBackend Backend> uint64_t pinnedPieces(int color) const;
+    template <SliderBackend Backend> bool inCheck() const { return isSquareAttacked<Backend>(kingSquare(sideToMove), sideToMove ^ 1); }
+    bool inCheck() const;
+    // static exchange evaluation: does the move win at least threshold once every capture back and
+    // forth on its target square has been played out, each side taking with its cheapest piece first
+    template <SliderBackend Backend> bool see(BitMove move, int threshold) const;
+
+    uint64_t piecesOf(int color, ChessPiece piece) const { return pieces[color][piece]; }
+    uint64_t colorOccupancy(int color) const { return pieces[color][NoPiece]; }
+    int kingSquare(int color) const;
+    // moves don't carry the piece, it's whatever stands on the from square before the move is made
+    ChessPiece movedPiece(BitMove move) const { return tagPiece(board[move.from()]); }
+
+    // piece movement
+    // generateMoves is strictly legal; the piece generators below only move onto the squares they're given
+    template <SliderBackend Backend> void generateMoves(MoveList& moves, MoveGenType type) const;
+    template <SliderBackend Backend> void generateAllMoves(MoveList& moves) const { generateMoves<Backend>(moves, GenAll); }
+    template <SliderBackend Backend> void generateCaptures(MoveList& moves) const { generateMoves<Backend>(moves, GenCaptures); }
+    template <SliderBackend Backend> void generateQuiets(MoveList& moves) const { generateMoves<Backend>(moves, GenQuiets); }
+    void generateMoves(MoveList& moves, MoveGenType type) const;
+    void generateAllMoves(MoveList& moves) const { generateMoves(moves, GenAll); }
+    // is a move from somewhere else (the hash table, a killer slot) legal here
+    template <SliderBackend Backend> bool isLegal(BitMove move) const;
+    bool isLegal(BitMove move) const;
+    void generateKnightMoves(MoveList& moves, BitBoard knightBoard, uint64_t empty_squares) const;
+    void generateKingMoves(MoveList& moves, int kingPos, uint64_t empty_squares) const;
+    void generateCastlingMoves(MoveList& moves, int kingPos, uint64_t kingDanger) const;
+    template <SliderBackend Backend> void generateBishopMoves(MoveList& moves, BitBoard bishopBoard, uint64_t empty_squares) const;
+    template <SliderBackend Backend> void generateRookMoves(MoveList& moves, BitBoard rookBoard, uint64_t empty_squares) const;
+    template <SliderBackend Backend> void generateQueenMoves(MoveList& moves, BitBoard queenBoard, uint64_t empty_squares) const;
+    void generatePawnMoves(MoveList& moves, BitBoard pawnBoard, uint64_t empty_squares, uint64_t enemyPieces, int color, uint64_t targets, MoveGenType type = GenAll) const;
+    template <SliderBackend Backend> void generateEnPassantMoves(MoveList& moves, BitBoard pawnBoard, int kingPos, uint64_t checkers) const;
+    void addPawnBitBoardMoves(MoveList& moves, const BitBoard pawnMove, const int shift, int flags) const;
+    void addPawnPromotions(MoveList& moves, const BitBoard pawnMove, const int shift, int flags) const;
+    // flag a move onto the square as a capture if something is there
+    int captureFlag(int square) const { return board[square] ? CaptureMove : QuietMove; }
+};
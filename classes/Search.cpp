@@ -0,0 +1,526 @@
+#include "Search.h"
+#include "Evaluation.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+// a capture that can't lift the score to alpha even with this much to spare isn't worth searching
+static const int DeltaMargin = 200;
+
+// how far the static eval has to clear beta, or fall short of alpha, per ply of depth left
+static const int ReverseFutilityMargin = 80;
+static const int ReverseFutilityDepth = 6;
+static const int FutilityMargin = 150;
+static const int FutilityDepth = 3;
+
+// null move cutoffs this deep get checked with a real search before they're trusted, in case of zugzwang
+static const int NullMoveVerifyDepth = 8;
+
+// half width of the first window tried around the last iteration's score
+static const int AspirationWindow = 25;
+
+// late move reductions by depth left and move number; later moves at deeper nodes come off more
+static int Reductions[MaxPly][64];
+
+static void initReductions()
+{
+    for (int depth = 1; depth < MaxPly; depth++) {
+        for (int moveNumber = 1; moveNumber < 64; moveNumber++) {
+            Reductions[depth][moveNumber] = (int)(0.75 + std::log(depth) * std::log(moveNumber) / 2.25);
+        }
+    }
+}
+
+// mate scores are stored relative to the node so they stay right wherever the position turns up again
+static int scoreToTT(int score, int ply)
+{
+    return score >= MateInMaxPly ? score + ply : score <= -MateInMaxPly ? score - ply : score;
+}
+
+static int scoreFromTT(int score, int ply)
+{
+    return score >= MateInMaxPly ? score - ply : score <= -MateInMaxPly ? score + ply : score;
+}
+
+SearchWorker::SearchWorker(Search& search, int index)
+    : _search(search), _index(index)
+{
+    _nodes = 0;
+    _pvLength[0] = 0;
+    _cutoffs = 0;
+    _firstMoveCutoffs = 0;
+    _nullMoveMinPly = 0;
+    _history.clear();
+}
+
+int SearchWorker::evaluate()
+{
+    return ::evaluate(_position, _pawnTable);
+}
+
+// adding up every thread's count or reading the clock costs more than a node, so the main thread
+// only looks every StopCheckInterval nodes
+bool SearchWorker::shouldStop()
+{
+    if (_index == 0 && (nodes() & (StopCheckInterval - 1)) == 0) {
+        const SearchLimits& limits = _search._limits;
+        if ((limits.nodes && _search.nodesSearched() >= limits.nodes) || _search._time.hardLimitReached()) {
+            _search._stop = true;
+        }
+    }
+    return _search._stop;
+}
+
+template <SliderBackend Backend>
+int SearchWorker::searchNode(int alpha, int beta, int depth, int ply)
+{
+    if (depth <= 0) {
+        return quiescence<Backend>(alpha, beta, ply);
+    }
+    bool pvNode = beta - alpha > 1;
+    _pvLength[ply] = ply;
+    _nodes.store(nodes() + 1, std::memory_order_relaxed);
+
+    if (shouldStop()) {
+        return 0;
+    }
+    if (ply > 0 && _position.isDrawByRule()) {
+        return 0;
+    }
+    if (ply >= MaxPly - 1) {
+        return evaluate();
+    }
+
+    TranspositionTable& tt = _search._tt;
+    TTData ttData;
+    bool ttHit = tt.probe(_position.key, ttData);
+    BitMove ttMove = ttHit ? BitMove(ttData.move) : BitMove{};
+    if (ttHit && !pvNode && ttData.depth >= depth) {
+        int ttScore = scoreFromTT(ttData.score, ply);
+        if (ttData.bound == BoundExact ||
+            (ttData.bound == BoundLower && ttScore >= beta) ||
+            (ttData.bound == BoundUpper && ttScore <= alpha)) {
+            return ttScore;
+        }
+    }
+
+    const SearchOptions& options = _search._options;
+    int us = _position.sideToMove;
+    bool inCheck = _position.inCheck<Backend>();
+    int staticEval = inCheck ? -Infinity : ttHit ? ttData.eval : evaluate();
+    bool lastMoveNull = !_position.undoStack.empty() && _position.undoStack.back().move.isNone();
+
+    if (!pvNode && !inCheck && std::abs(beta) < MateInMaxPly) {
+        // so far ahead that even a bad move should still clear beta
+        if (options.reverseFutility && depth <= ReverseFutilityDepth
+            && staticEval - ReverseFutilityMargin * depth >= beta) {
+            return staticEval;
+        }
+
+        // give the opponent a free move; if a shallower search still fails high, a real move would too.
+        // not with only pawns left, where passing can be the only thing that doesn't lose
+        uint64_t pieces = _position.colorOccupancy(us) & ~_position.piecesOf(us, Pawn) & ~_position.piecesOf(us, King);
+        if (options.nullMove && depth >= 3 && ply >= _nullMoveMinPly && !lastMoveNull && pieces && staticEval >= beta) {
+            int reduction = 3 + depth / 4;
+            _position.makeNullMove();
+            int score = -searchNode<Backend>(-beta, -beta + 1, depth - 1 - reduction, ply + 1);
+            _position.unmakeNullMove();
+            if (_search._stop) {
+                return 0;
+            }
+            if (score >= beta) {
+                // a mate found after passing isn't a real one
+                score = std::min(score, MateInMaxPly - 1);
+                if (depth < NullMoveVerifyDepth || _nullMoveMinPly) {
+                    return score;
+                }
+                // search again without null moves for a while and only trust the cutoff if that agrees
+                _nullMoveMinPly = ply + 3 * (depth - reduction) / 4;
+                int verified = searchNode<Backend>(beta - 1, beta, depth - reduction, ply);
+                _nullMoveMinPly = 0;
+                if (verified >= beta) {
+                    return score;
+                }
+            }
+        }
+    }
+
+    // the quiet reply that refuted the last move here before
+    BitMove counterMove{};
+    if (!_position.undoStack.empty() && !lastMoveNull) {
+        int lastTo = _position.undoStack.back().move.to();
+        uint8_t lastTag = _position.board[lastTo];
+        counterMove = _history.counterMoves[tagColor(lastTag)][tagPiece(lastTag)][lastTo];
+    }
+
+    MovePicker<Backend> picker(_position, ttMove, _history.killers[ply], counterMove, _history.butterfly[us]);
+    // helpers shuffle the root quiets a little so they don't all walk the same tree
+    if (ply == 0 && _index > 0) {
+        picker.perturbQuiets(_index);
+    }
+
+    // quiets this close to the leaves can't make up the gap to alpha
+    bool futile = options.futility && !pvNode && !inCheck && depth <= FutilityDepth
+                  && staticEval + FutilityMargin * depth <= alpha;
+
+    int bestScore = -Infinity;
+    BitMove bestMove{};
+    BitMove quietsTried[64];
+    int quietCount = 0;
+    int moveNumber = 0;
+    for (BitMove move = picker.nextMove(); !move.isNone(); move = picker.nextMove(), moveNumber++) {
+        bool quiet = !move.isCapture() && !move.isPromotion();
+        uint64_t nodesBefore = nodes();
+        _position.makeMove(move);
+        tt.prefetch(_position.key);
+        bool givesCheck = _position.inCheck<Backend>();
+        if (futile && moveNumber > 0 && quiet && !givesCheck) {
+            _position.unmakeMove();
+            continue;
+        }
+
+        int newDepth = depth - 1;
+        int score;
+        if (moveNumber == 0) {
+            score = -searchNode<Backend>(-beta, -alpha, newDepth, ply + 1);
+        } else {
+            int reduction = 0;
+            if (options.lateMoveReductions && depth >= 3 && moveNumber >= 3 && quiet && !inCheck && !givesCheck) {
+                reduction = Reductions[depth][std::min(moveNumber, 63)] - pvNode;
+                reduction = std::clamp(reduction, 0, newDepth - 1);
+            }
+            // prove this move is no better than the one we have, and only search it properly if it is
+            score = -searchNode<Backend>(-alpha - 1, -alpha, newDepth - reduction, ply + 1);
+            if (score > alpha && reduction) {
+                score = -searchNode<Backend>(-alpha - 1, -alpha, newDepth, ply + 1);
+            }
+            if (score > alpha && score < beta) {
+                score = -searchNode<Backend>(-beta, -alpha, newDepth, ply + 1);
+            }
+        }
+        _position.unmakeMove();
+        if (ply == 0) {
+            _rootEffort[move.from()][move.to()] += nodes() - nodesBefore;
+        }
+        if (_search._stop) {
+            return 0;
+        }
+
+        if (score > bestScore) {
+            bestScore = score;
+            if (score > alpha) {
+                alpha = score;
+                bestMove = move;
+                _pv[ply][ply] = move;
+                for (int next = ply + 1; next < _pvLength[ply + 1]; next++) {
+                    _pv[ply][next] = _pv[ply + 1][next];
+                }
+                _pvLength[ply] = _pvLength[ply + 1];
+                if (alpha >= beta) {
+                    _cutoffs++;
+                    _firstMoveCutoffs += moveNumber == 0;
+                    if (quiet) {
+                        updateQuietHistory(move, depth, ply, quietsTried, quietCount);
+                    }
+                    break;
+                }
+            }
+        }
+        if (quiet && quietCount < 64) {
+            quietsTried[quietCount++] = move;
+        }
+    }
+
+    // the picker only finds out there are no moves once it's looked at every stage
+    if (bestScore == -Infinity) {
+        return _position.inCheck<Backend>() ? -MateScore + ply : 0;
+    }
+
+    TTBound bound = bestScore >= beta ? BoundLower : !bestMove.isNone() ? BoundExact : BoundUpper;
+    // in check staticEval is -Infinity, which is never read back: the position is in check whenever it's probed
+    tt.store(_position.key, depth, scoreToTT(bestScore, ply), staticEval, bestMove.raw(), bound);
+    return bestScore;
+}
+
+//
+// the side to move can stand pat on the static evaluation instead of capturing, unless it's in check,
+// where every evasion gets searched and no moves means mate.
+// captures that lose material by SEE never come out of the picker, and captures that can't reach
+// alpha even winning the piece outright are skipped
+//
+template <SliderBackend Backend>
+int SearchWorker::quiescence(int alpha, int beta, int ply)
+{
+    _pvLength[ply] = ply;
+    _nodes.store(nodes() + 1, std::memory_order_relaxed);
+
+    if (shouldStop()) {
+        return 0;
+    }
+    if (_position.isDrawByRule()) {
+        return 0;
+    }
+    if (ply >= MaxPly - 1) {
+        return evaluate();
+    }
+
+    bool inCheck = _position.inCheck<Backend>();
+    int standPat = -Infinity;
+    int bestScore = -Infinity;
+    if (!inCheck) {
+        standPat = evaluate();
+        if (standPat >= beta) {
+            return standPat;
+        }
+        alpha = std::max(alpha, standPat);
+        bestScore = standPat;
+    }
+
+    BitMove noKillers[2] = {};
+    int us = _position.sideToMove;
+    MovePicker<Backend> picker = inCheck ? MovePicker<Backend>(_position, BitMove{}, noKillers, BitMove{}, _history.butterfly[us])
+                                         : MovePicker<Backend>(_position);
+    bool anyMoves = false;
+    for (BitMove move = picker.nextMove(); !move.isNone(); move = picker.nextMove()) {
+        anyMoves = true;
+        if (!inCheck && !move.isPromotion()) {
+            int victim = move.flags() == EnPassantCapture ? Pawn : tagPiece(_position.board[move.to()]);
+            if (standPat + SeeValues[victim] + DeltaMargin <= alpha) {
+                continue;
+            }
+        }
+
+        _position.makeMove(move);
+        int score = -quiescence<Backend>(-beta, -alpha, ply + 1);
+        _position.unmakeMove();
+        if (_search._stop) {
+            return 0;
+        }
+
+        if (score > bestScore) {
+            bestScore = score;
+            if (score > alpha) {
+                alpha = score;
+                _pv[ply][ply] = move;
+                for (int next = ply + 1; next < _pvLength[ply + 1]; next++) {
+                    _pv[ply][next] = _pv[ply + 1][next];
+                }
+                _pvLength[ply] = _pvLength[ply + 1];
+                if (alpha >= beta) {
+                    break;
+                }
+            }
+        }
+    }
+
+    if (inCheck && !anyMoves) {
+        return -MateScore + ply;
+    }
+    return bestScore;
+}
+
+void SearchWorker::updateQuietHistory(BitMove move, int depth, int ply, const BitMove* quietsTried, int quietCount)
+{
+    BitMove* killers = _history.killers[ply];
+    if (killers[0] != move) {
+        killers[1] = killers[0];
+        killers[0] = move;
+    }
+    if (!_position.undoStack.empty() && !_position.undoStack.back().move.isNone()) {
+        int lastTo = _position.undoStack.back().move.to();
+        uint8_t lastTag = _position.board[lastTo];
+        _history.counterMoves[tagColor(lastTag)][tagPiece(lastTag)][lastTo] = move;
+    }
+
+    // deeper cutoffs say more about the move, but cap it so one big search doesn't swamp the table
+    int bonus = std::min(32 * depth * depth, HistoryMax / 8);
+    int (*history)[64] = _history.butterfly[_position.sideToMove];
+    MoveHistory::addBonus(history[move.from()][move.to()], bonus);
+    for (int i = 0; i < quietCount; i++) {
+        MoveHistory::addBonus(history[quietsTried[i].from()][quietsTried[i].to()], -bonus);
+    }
+}
+
+void SearchWorker::iterate(const Position& position, SearchResult& result)
+{
+    _position = position;
+    _nodes = 0;
+    _cutoffs = 0;
+    _firstMoveCutoffs = 0;
+    _nullMoveMinPly = 0;
+    _history.clear();
+
+    MoveList rootMoves;
+    _position.generateAllMoves(rootMoves);
+    if (rootMoves.empty()) {
+        return;
+    }
+    result.bestMove = rootMoves[0];
+
+    // pick the slider lookups once here; everything below runs on them without asking again
+    if (SliderBackendInUse == SliderPext) {
+        deepen<SliderPext>(result, rootMoves.size());
+    } else {
+        deepen<SliderMagic>(result, rootMoves.size());
+    }
+}
+
+template <SliderBackend Backend>
+void SearchWorker::deepen(SearchResult& result, int rootMoveCount)
+{
+    // odd helpers run one ply ahead of the main thread
+    const SearchLimits& limits = _search._limits;
+    for (int depth = 1 + (_index & 1); depth <= limits.depth && depth < MaxPly; depth++) {
+        // the time manager wants this iteration's split of the nodes, not the whole think's
+        memset(_rootEffort, 0, sizeof(_rootEffort));
+        uint64_t iterationStart = nodes();
+        int score = aspirationSearch<Backend>(depth, result.score);
+        // a stopped iteration hasn't looked at every move, so keep the last complete one
+        if (_search._stop) {
+            break;
+        }
+        result.score = score;
+        result.depth = depth;
+        result.pv.assign(_pv[0], _pv[0] + _pvLength[0]);
+        if (!result.pv.empty()) {
+            result.bestMove = result.pv[0];
+        }
+        result.firstMoveCutoffRate = _cutoffs ? 100.0 * _firstMoveCutoffs / _cutoffs : 0.0;
+        if (_index == 0 && _search._report) {
+            result.nodes = _search.nodesSearched();
+            result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - _search._startTime).count();
+            _search.report(result);
+        }
+        // nothing deeper will change a forced mate we've already found
+        if (score >= MateInMaxPly || score <= -MateInMaxPly) {
+            break;
+        }
+        if (_index == 0 && _search._time.isTimed()) {
+            // with only one move there's nothing to think about
+            if (rootMoveCount == 1) {
+                break;
+            }
+            double effort = (double)_rootEffort[result.bestMove.from()][result.bestMove.to()]
+                            / std::max<uint64_t>(nodes() - iterationStart, 1);
+            if (_search._time.stopAfterIteration(result.bestMove, score, effort)) {
+                break;
+            }
+        }
+    }
+}
+
+//
+// search around the last score with a narrow window, which cuts more than a full one, and widen
+// whichever side the score falls out of until it lands inside
+//
+template <SliderBackend Backend>
+int SearchWorker::aspirationSearch(int depth, int lastScore)
+{
+    if (!_search._options.aspirationWindows || depth < 4 || std::abs(lastScore) >= MateInMaxPly) {
+        return searchNode<Backend>(-Infinity, Infinity, depth, 0);
+    }
+    int delta = AspirationWindow;
+    int alpha = std::max(lastScore - delta, -Infinity);
+    int beta = std::min(lastScore + delta, Infinity);
+    while (true) {
+        int score = searchNode<Backend>(alpha, beta, depth, 0);
+        if (_search._stop) {
+            return score;
+        }
+        if (score <= alpha) {
+            alpha = std::max(score - delta, -Infinity);
+        } else if (score >= beta) {
+            beta = std::min(score + delta, Infinity);
+        } else {
+            return score;
+        }
+        delta *= 2;
+    }
+}
+
+Search::Search()
+{
+    initReductions();
+    _stop = false;
+    _report = true;
+    setThreads(1);
+}
+
+Search::~Search()
+{
+}
+
+void Search::setThreads(int threads)
+{
+    _workers.clear();
+    for (int i = 0; i < std::max(threads, 1); i++) {
+        _workers.push_back(std::make_unique<SearchWorker>(*this, i));
+    }
+}
+
+uint64_t Search::nodesSearched() const
+{
+    uint64_t nodes = 0;
+    for (auto& worker : _workers) {
+        nodes += worker->nodes();
+    }
+    return nodes;
+}
+
+SearchResult Search::think(const Position& position, const SearchLimits& limits)
+{
+    _limits = limits;
+    _stop = false;
+    _startTime = std::chrono::steady_clock::now();
+    _time.start(limits, _startTime);
+    _tt.newSearch();
+
+    // helpers only feed the table, their own results are thrown away
+    std::vector<std::thread> helpers;
+    std::vector<SearchResult> helperResults(_workers.size());
+    for (size_t i = 1; i < _workers.size(); i++) {
+        helpers.emplace_back([&, i]() {
+            _workers[i]->iterate(position, helperResults[i]);
+        });
+    }
+
+    SearchResult result;
+    _workers[0]->iterate(position, result);
+
+    // the main thread is done, so everyone is
+    _stop = true;
+    for (auto& helper : helpers) {
+        helper.join();
+    }
+
+    result.nodes = nodesSearched();
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - _startTime).count();
+    return result;
+}
+
+// one line per iteration in the same shape engines print them: depth, score, nodes, nps, hashfull, pv,
+// plus fmc, the share of cutoffs the first move tried produced
+void Search::report(const SearchResult& result) const
+{
+    std::cout << "info depth " << result.depth << " score ";
+    if (result.score >= MateInMaxPly) {
+        std::cout << "mate " << (MateScore - result.score + 1) / 2;
+    } else if (result.score <= -MateInMaxPly) {
+        std::cout << "mate " << -(MateScore + result.score) / 2;
+    } else {
+        std::cout << "cp " << result.score;
+    }
+    std::cout << " nodes " << result.nodes
+              << " nps " << (uint64_t)(result.seconds > 0 ? result.nodes / result.seconds : 0)
+              << " time " << (int)(result.seconds * 1000)
+              << " hashfull " << _tt.hashfull()
+              << " fmc " << (int)(result.firstMoveCutoffRate * 10) / 10.0 << "%"
+              << " pv";
+    for (BitMove move : result.pv) {
+        std::cout << " " << move.notation();
+    }
+    std::cout << std::endl;
+}
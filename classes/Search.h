@@ -0,0 +1,144 @@
+#pragma once
+
+#include "MovePicker.h"
+#include "PawnTable.h"
+#include "Position.h"
+#include "TimeManager.h"
+#include "TranspositionTable.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+constexpr int Infinity = 32001;
+constexpr int MateScore = 32000;
+// scores past this are mates, counted in plies from the root
+constexpr int MateInMaxPly = MateScore - MaxPly;
+
+// when to stop thinking
+struct SearchLimits
+{
+    int         depth = MaxPly - 1;
+    uint64_t    nodes = 0;          // 0 for no limit, counted over every thread
+    // the clock, in milliseconds
+    int64_t     time = 0;           // the side to move's time left, 0 for an untimed search
+    int64_t     increment = 0;      // added to that after every move
+    int         movesToGo = 0;      // moves left until the next time control, 0 for the rest of the game
+    int64_t     moveTime = 0;       // think exactly this long, whatever the clock says
+};
+
+// the pruning and reduction techniques, each one switchable so bench can measure what it buys
+struct SearchOptions
+{
+    bool        nullMove = true;            // pass, and prune if the opponent still can't get below beta
+    bool        lateMoveReductions = true;  // search late quiets shallower, and again properly if they beat alpha
+    bool        reverseFutility = true;     // prune when the static eval is far enough above beta near the leaves
+    bool        futility = true;            // skip quiets near the leaves when the static eval is far below alpha
+    bool        aspirationWindows = true;   // start each iteration with a narrow window around the last score
+};
+
+// what a finished (or stopped) search settled on
+struct SearchResult
+{
+    BitMove     bestMove{};
+    int         score = 0;
+    int         depth = 0;
+    uint64_t    nodes = 0;
+    double      seconds = 0.0;
+    // percent of beta cutoffs that came from the first move tried, a measure of move ordering
+    double      firstMoveCutoffRate = 0.0;
+    std::vector<BitMove> pv;
+};
+
+class Search;
+
+//
+// everything one search thread needs of its own; they only share the transposition table
+// and the stop flag. worker 0 runs on the calling thread and is the one whose result counts
+//
+class SearchWorker
+{
+public:
+    SearchWorker(Search& search, int index);
+
+    // iterative deepening on a copy of position until the depth limit or a stop
+    void        iterate(const Position& position, SearchResult& result);
+    uint64_t    nodes() const { return _nodes.load(std::memory_order_relaxed); }
+
+private:
+    // the deepening loop and everything under it run on the slider backend iterate picked
+    template <SliderBackend Backend> void deepen(SearchResult& result, int rootMoveCount);
+    template <SliderBackend Backend> int aspirationSearch(int depth, int lastScore);
+    template <SliderBackend Backend> int searchNode(int alpha, int beta, int depth, int ply);
+    // captures only from the leaves until the position is quiet, so the evaluation never lands mid exchange
+    template <SliderBackend Backend> int quiescence(int alpha, int beta, int ply);
+    int         evaluate();
+    bool        shouldStop();
+    // a quiet move caused a cutoff: remember it and mark down the quiets tried before it
+    void        updateQuietHistory(BitMove move, int depth, int ply, const BitMove* quietsTried, int quietCount);
+
+    Search&     _search;
+    int         _index;
+    Position    _position;
+    // only this thread writes it, the others just read it for reporting
+    std::atomic<uint64_t> _nodes;
+
+    // triangular principal variation: _pv[ply] holds the best line found from that ply down
+    BitMove     _pv[MaxPly][MaxPly];
+    int         _pvLength[MaxPly];
+
+    MoveHistory _history;
+    PawnTable   _pawnTable;
+    // no null moves above this ply, while a null move cutoff is being verified
+    int         _nullMoveMinPly;
+    uint64_t    _cutoffs;
+    uint64_t    _firstMoveCutoffs;
+    // nodes spent under each root move by from and to in the current iteration, for the time manager
+    uint64_t    _rootEffort[64][64];
+};
+
+//
+// iterative deepening principal variation search
+// each iteration searches the first move with the full window and every other move with a null
+// window, re-searching only the ones that beat it. the transposition table hands the best move from
+// the last iteration back as the first move to try, so the deeper searches start with a good bound.
+//
+// with more than one thread it runs lazy SMP: every helper searches the same root at slightly
+// different depths and move orders and they all write into the shared table, so each one finds the
+// others' results waiting and the main thread gets deeper in the same time
+//
+class Search
+{
+public:
+    Search();
+    ~Search();
+
+    // search a copy of position until the limits run out; prints a line per finished iteration
+    SearchResult think(const Position& position, const SearchLimits& limits);
+    // ask a running think to return as soon as it can, safe from any thread
+    void        stop() { _stop = true; }
+
+    void        setThreads(int threads);
+    int         threads() const { return (int)_workers.size(); }
+    TranspositionTable& transpositionTable() { return _tt; }
+    // print the info line after each iteration
+    void        setReporting(bool report) { _report = report; }
+    // only between searches
+    void        setOptions(const SearchOptions& options) { _options = options; }
+    const SearchOptions& options() const { return _options; }
+
+private:
+    friend class SearchWorker;
+
+    uint64_t    nodesSearched() const;
+    void        report(const SearchResult& result) const;
+
+    TranspositionTable _tt;
+    std::vector<std::unique_ptr<SearchWorker>> _workers;
+    SearchLimits _limits;
+    TimeManager _time;
+    SearchOptions _options;
+    std::atomic<bool> _stop;
+    bool        _report;
+    std::chrono::steady_clock::time_point _startTime;
+};
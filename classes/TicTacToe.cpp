@@ -1,4 +1,5 @@
 #include "TicTacToe.h"
+#include "TicTacToeRules.h"
 
 
 TicTacToe::TicTacToe()
@@ -8,6 +9,7 @@ TicTacToe::TicTacToe()
 
 TicTacToe::~TicTacToe()
 {
+    stopAI();
     delete _grid;
 }
 
@@ -162,86 +164,43 @@ void TicTacToe::setStateString(const std::string &s)
 // this is the function that will be called by the AI
 //
 void TicTacToe::updateAI() 
+{
+    prepareAI();
+    applyAIMove(thinkAI());
+}
+
+int TicTacToe::thinkAI()
 {
     int bestVal = -1000;
-    BitHolder* bestMove = nullptr;
-    std::string state = stateString();
+    int bestMove = -1;
+    std::string state = _aiState;
 
     // Traverse all cells, evaluate minimax function for all empty cells
-    _grid->forEachSquare([&](ChessSquare* square, int x, int y) {
-        int index = y * 3 + x;
+    for (int index = 0; index < 9; index++) {
         // Check if cell is empty
         if (state[index] == '0') {
             // Make the move
             state[index] = '2';
-            int moveVal = -negamax(state, 0, HUMAN_PLAYER);
+            int moveVal = -ticTacToeNegamax(state, 0, HUMAN_PLAYER);
             // Undo the move
             state[index] = '0';
             // If the value of the current move is more than the best value, update best
             if (moveVal > bestVal) {
-                bestMove = square;
+                bestMove = index;
                 bestVal = moveVal;
             }
         }
-    });
-
-
-    // Make the best move
-    if(bestMove) {
-        if (actionForEmptyHolder(*bestMove)) {
-        }
     }
+    return bestMove;
 }
 
-bool isAIBoardFull(const std::string& state) {
-    return state.find('0') == std::string::npos;
-}
-
-int evaluateAIBoard(const std::string& state) {
-    static const int kWinningTriples[8][3] =  { {0,1,2}, {3,4,5}, {6,7,8},  // rows
-                                                {0,3,6}, {1,4,7}, {2,5,8},  // cols
-                                                {0,4,8}, {2,4,6} };         // diagonals
-    for( int i=0; i<8; i++ ) {
-        const int *triple = kWinningTriples[i];
-        char first = state[triple[0]];
-        if( first != '0' && first == state[triple[1]] && first == state[triple[2]] ) {
-            return 10;   // someone won, negamax will handle who
-        }
-    }
-    return 0; // No winner
-}
-
-//
-// player is the current player's number (AI or human)
-//
-int TicTacToe::negamax(std::string& state, int depth, int playerColor) 
+void TicTacToe::applyAIMove(int move)
 {
-    int score = evaluateAIBoard(state);
-
-    // Check if AI wins, human wins, or draw
-    if(score) { 
-        // A winning state is a loss for the player whose turn it is.
-        // The previous player made the winning move.
-        return -score; 
-    }
-
-    if(isAIBoardFull(state)) {
-        return 0; // Draw
-    }
-
-    int bestVal = -1000; // Min value
-    for (int y = 0; y < 3; y++) {
-        for (int x = 0; x < 3; x++) {
-            // Check if cell is empty
-            if (state[y * 3 + x] == '0') {
-                // Make the move
-                state[y * 3 + x] = playerColor == HUMAN_PLAYER ? '1' : '2'; // Set the cell to the current player's color
-                bestVal = std::max(bestVal, -negamax(state, depth + 1, -playerColor));
-                // Undo the move for backtracking
-                state[y * 3 + x] = '0';
-            }
+    // Make the best move, unless the board changed under the search
+    if (move >= 0 && stateString() == _aiState) {
+        ChessSquare* square = _grid->getSquare(move % 3, move / 3);
+        if (square) {
+            actionForEmptyHolder(*square);
         }
     }
-
-    return bestVal;
-}
\ No newline at end of file
+}
@@ -29,12 +29,17 @@ public:
 
 	void        updateAI() override;
     bool        gameHasAI() override { return true; }
+    bool        hasBackgroundAI() override { return true; }
+    void        prepareAI() override { _aiState = stateString(); }
+    int         thinkAI() override;
+    void        applyAIMove(int move) override;
     Grid* getGrid() override { return _grid; }
 private:
     Bit *       PieceForPlayer(const int playerNumber);
     Player*     ownerAt(int index ) const;
-    int         negamax(std::string& state, int depth, int playerColor);
 
     Grid*       _grid;
+    // the board the AI thread works from
+    std::string _aiState;
 };
 
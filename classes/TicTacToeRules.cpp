@@ -0,0 +1,55 @@
+#include "TicTacToeRules.h"
+#include <algorithm>
+
+bool isAIBoardFull(const std::string& state) {
+    return state.find('0') == std::string::npos;
+}
+
+int evaluateAIBoard(const std::string& state) {
+    static const int kWinningTriples[8][3] =  { {0,1,2}, {3,4,5}, {6,7,8},  // rows
+                                                {0,3,6}, {1,4,7}, {2,5,8},  // cols
+                                                {0,4,8}, {2,4,6} };         // diagonals
+    for( int i=0; i<8; i++ ) {
+        const int *triple = kWinningTriples[i];
+        char first = state[triple[0]];
+        if( first != '0' && first == state[triple[1]] && first == state[triple[2]] ) {
+            return 10;   // someone won, negamax will handle who
+        }
+    }
+    return 0; // No winner
+}
+
+//
+// player is the current player's number (AI or human)
+//
+int ticTacToeNegamax(std::string& state, int depth, int playerColor) 
+{
+    int score = evaluateAIBoard(state);
+
+    // Check if AI wins, human wins, or draw
+    if(score) { 
+        // A winning state is a loss for the player whose turn it is.
+        // The previous player made the winning move.
+        return -score; 
+    }
+
+    if(isAIBoardFull(state)) {
+        return 0; // Draw
+    }
+
+    int bestVal = -1000; // Min value
+    for (int y = 0; y < 3; y++) {
+        for (int x = 0; x < 3; x++) {
+            // Check if cell is empty
+            if (state[y * 3 + x] == '0') {
+                // Make the move
+                state[y * 3 + x] = playerColor == HUMAN_PLAYER ? '1' : '2'; // Set the cell to the current player's color
+                bestVal = std::max(bestVal, -ticTacToeNegamax(state, depth + 1, -playerColor));
+                // Undo the move for backtracking
+                state[y * 3 + x] = '0';
+            }
+        }
+    }
+
+    return bestVal;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "GameRules.h"
+#include <string>
+
+//
+// tic tac toe rules on the state string alone, no sprites or textures
+// the state is 9 characters, row by row: '0' empty, '1' for X (the human), '2' for O (the AI)
+//
+
+// true when there are no empty cells left
+bool isAIBoardFull(const std::string& state);
+
+// 10 if either side has three in a row, 0 otherwise; negamax works out whose win it was
+int evaluateAIBoard(const std::string& state);
+
+// best score for the side to move; playerColor is HUMAN_PLAYER when X is to move and AI_PLAYER when O is
+int ticTacToeNegamax(std::string& state, int depth, int playerColor);
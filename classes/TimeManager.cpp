@@ -0,0 +1,75 @@
+#include "TimeManager.h"
+#include "Search.h"
+#include <algorithm>
+
+// kept back from every move for the window to draw and the move to be played
+static const int64_t MoveOverhead = 30;
+// with no moves to go, plan as if the game had this many moves left
+static const int DefaultMovesToGo = 30;
+// the hard limit is at most this many soft limits
+static const int MaxStretch = 4;
+// a best move that's had this share of the nodes is as good as settled
+static const double DominantEffort = 0.9;
+// a score that falls this far over one iteration gets the most extra time
+static const int FallingScoreRange = 200;
+
+void TimeManager::start(const SearchLimits& limits, std::chrono::steady_clock::time_point startTime)
+{
+    _startTime = startTime;
+    _timed = limits.moveTime > 0 || limits.time > 0;
+    _fixed = limits.moveTime > 0;
+    _lastBestMove = BitMove{};
+    _lastScore = 0;
+    _iterations = 0;
+    _instability = 0.0;
+
+    if (_fixed) {
+        _softLimit = _hardLimit = std::max<int64_t>(limits.moveTime - MoveOverhead, 1);
+        return;
+    }
+    if (!_timed) {
+        _softLimit = _hardLimit = 0;
+        return;
+    }
+
+    int64_t available = std::max<int64_t>(limits.time - MoveOverhead, 1);
+    int movesToGo = limits.movesToGo > 0 ? std::min(limits.movesToGo, DefaultMovesToGo) : DefaultMovesToGo;
+    _softLimit = available / movesToGo + limits.increment * 3 / 4;
+    // never bet more than a third of the clock on one move, unless it's the last before the control
+    int64_t cap = movesToGo == 1 ? available * 4 / 5 : available / 3;
+    _hardLimit = std::max<int64_t>(std::min(_softLimit * MaxStretch, cap), 1);
+    _softLimit = std::max<int64_t>(std::min(_softLimit, _hardLimit), 1);
+}
+
+int64_t TimeManager::elapsed() const
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - _startTime).count();
+}
+
+bool TimeManager::stopAfterIteration(BitMove bestMove, int score, double effort)
+{
+    if (!_timed || _fixed) {
+        return false;
+    }
+
+    _instability *= 0.5;
+    if (_iterations > 0 && bestMove != _lastBestMove) {
+        _instability += 1.0;
+    }
+    double scale = 1.0 + _instability;
+
+    // losing ground since the last iteration: keep looking for something better
+    if (_iterations > 0 && score < _lastScore) {
+        scale *= 1.0 + 0.5 * std::min(_lastScore - score, FallingScoreRange) / FallingScoreRange;
+    }
+
+    // everything else has been refuted cheaply for a while now
+    if (effort >= DominantEffort && _instability < 0.1) {
+        scale *= 0.5;
+    }
+
+    _lastBestMove = bestMove;
+    _lastScore = score;
+    _iterations++;
+    return elapsed() >= std::min<int64_t>((int64_t)(_softLimit * scale), _hardLimit);
+}
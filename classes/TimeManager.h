@@ -0,0 +1,47 @@
+#pragma once
+
+#include "Position.h"
+#include <chrono>
+#include <cstdint>
+
+struct SearchLimits;
+
+//
+// decides how long a search gets out of the clock
+// - the soft limit is this move's share of the clock. it's only checked between iterations, and
+//   stretched or shrunk by how settled the search looks: more time when the best move keeps changing
+//   or the score is falling, less when one move is taking nearly all the effort
+// - the hard limit is the most the move may ever take, checked from inside the search
+//
+
+// nodes between the search's looks at the clock, a power of two
+constexpr uint64_t StopCheckInterval = 2048;
+
+class TimeManager
+{
+public:
+    void        start(const SearchLimits& limits, std::chrono::steady_clock::time_point startTime);
+    bool        isTimed() const { return _timed; }
+    int64_t     elapsed() const;
+    bool        hardLimitReached() const { return _timed && elapsed() >= _hardLimit; }
+    // after each finished iteration: whether another one is worth starting.
+    // effort is the share of the iteration's nodes spent under bestMove
+    bool        stopAfterIteration(BitMove bestMove, int score, double effort);
+
+    int64_t     softLimit() const { return _softLimit; }
+    int64_t     hardLimit() const { return _hardLimit; }
+
+private:
+    std::chrono::steady_clock::time_point _startTime;
+    bool        _timed;
+    // movetime searches run to the hard limit however the search is going
+    bool        _fixed;
+    int64_t     _softLimit;
+    int64_t     _hardLimit;
+
+    BitMove     _lastBestMove;
+    int         _lastScore;
+    int         _iterations;
+    // recent best move changes, halving every iteration
+    double      _instability;
+};
@@ -0,0 +1,159 @@
+#include "TranspositionTable.h"
+#include <atomic>
+#include <cstring>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+//
+// packed data layout
+//  0-15  move
+// 16-31  score
+// 32-47  static eval
+// 48-55  depth
+// 56-57  bound
+// 58-63  generation
+//
+static uint64_t packData(uint16_t move, int score, int eval, int depth, TTBound bound, uint8_t generation)
+{
+    return (uint64_t)move
+         | (uint64_t)(uint16_t)score << 16
+         | (uint64_t)(uint16_t)eval << 32
+         | (uint64_t)(uint8_t)depth << 48
+         | (uint64_t)bound << 56
+         | (uint64_t)generation << 58;
+}
+
+static int dataDepth(uint64_t data) { return (int8_t)(data >> 48); }
+static TTBound dataBound(uint64_t data) { return (TTBound)((data >> 56) & 3); }
+static uint8_t dataGeneration(uint64_t data) { return (uint8_t)(data >> 58); }
+
+// other threads write these while we read them; relaxed atomics are plain loads and stores on x86
+static uint64_t loadRelaxed(const uint64_t& value)
+{
+    return std::atomic_ref<uint64_t>(const_cast<uint64_t&>(value)).load(std::memory_order_relaxed);
+}
+
+static void storeRelaxed(uint64_t& value, uint64_t newValue)
+{
+    std::atomic_ref<uint64_t>(value).store(newValue, std::memory_order_relaxed);
+}
+
+TranspositionTable::TranspositionTable()
+{
+    _clusters = nullptr;
+    _clusterCount = 0;
+    _generation = 0;
+    resize(16);
+}
+
+TranspositionTable::~TranspositionTable()
+{
+    delete[] _clusters;
+}
+
+void TranspositionTable::resize(size_t megabytes)
+{
+    delete[] _clusters;
+    _clusterCount = megabytes * 1024 * 1024 / sizeof(TTCluster);
+    if (_clusterCount == 0) {
+        _clusterCount = 1;
+    }
+    _clusters = new TTCluster[_clusterCount];
+    clear();
+}
+
+void TranspositionTable::clear()
+{
+    memset(_clusters, 0, _clusterCount * sizeof(TTCluster));
+    _generation = 0;
+}
+
+// map the key onto [0, _clusterCount) with the high half of a 64x64 multiply, so any size works
+TTCluster* TranspositionTable::clusterFor(uint64_t key) const
+{
+#if defined(_MSC_VER)
+    return &_clusters[__umulh(key, _clusterCount)];
+#else
+    return &_clusters[(size_t)(((unsigned __int128)key * _clusterCount) >> 64)];
+#endif
+}
+
+void TranspositionTable::prefetch(uint64_t key) const
+{
+#if defined(_MSC_VER)
+    _mm_prefetch((const char*)clusterFor(key), _MM_HINT_T0);
+#else
+    __builtin_prefetch(clusterFor(key));
+#endif
+}
+
+bool TranspositionTable::probe(uint64_t key, TTData& data) const
+{
+    const TTCluster* cluster = clusterFor(key);
+    for (const TTEntry& entry : cluster->entries) {
+        uint64_t packed = loadRelaxed(entry.data);
+        if ((loadRelaxed(entry.keyXorData) ^ packed) != key || dataBound(packed) == BoundNone) {
+            continue;
+        }
+        data.move = (uint16_t)packed;
+        data.score = (int16_t)(packed >> 16);
+        data.eval = (int16_t)(packed >> 32);
+        data.depth = (int8_t)dataDepth(packed);
+        data.bound = dataBound(packed);
+        return true;
+    }
+    return false;
+}
+
+//
+// replacement: the same position is always updated in place; otherwise the entry that is
+// shallowest once it's been marked down 8 plies for every search it has sat unused is the one to go
+//
+void TranspositionTable::store(uint64_t key, int depth, int score, int eval, uint16_t move, TTBound bound)
+{
+    TTCluster* cluster = clusterFor(key);
+    TTEntry* replace = &cluster->entries[0];
+    int replaceValue = 1 << 30;
+
+    for (TTEntry& entry : cluster->entries) {
+        uint64_t packed = loadRelaxed(entry.data);
+        if ((loadRelaxed(entry.keyXorData) ^ packed) == key) {
+            // keep a deeper result from this search unless the new one is exact
+            if (bound != BoundExact && dataGeneration(packed) == _generation && dataDepth(packed) > depth + 3) {
+                return;
+            }
+            // a fail low carries no move, don't lose the one we had
+            if (!move) {
+                move = (uint16_t)packed;
+            }
+            replace = &entry;
+            break;
+        }
+        int value = dataBound(packed) == BoundNone ? -(1 << 20)
+                  : dataDepth(packed) - 8 * ((_generation - dataGeneration(packed)) & 63);
+        if (value < replaceValue) {
+            replaceValue = value;
+            replace = &entry;
+        }
+    }
+
+    uint64_t packed = packData(move, score, eval, depth, bound, _generation);
+    storeRelaxed(replace->data, packed);
+    storeRelaxed(replace->keyXorData, key ^ packed);
+}
+
+int TranspositionTable::hashfull() const
+{
+    size_t sample = _clusterCount < 1000 ? _clusterCount : 1000;
+    int used = 0;
+    for (size_t i = 0; i < sample; i++) {
+        for (const TTEntry& entry : _clusters[i].entries) {
+            uint64_t packed = loadRelaxed(entry.data);
+            if (dataBound(packed) != BoundNone && dataGeneration(packed) == _generation) {
+                used++;
+            }
+        }
+    }
+    return sample ? (int)(used * 1000 / (sample * 4)) : 0;
+}
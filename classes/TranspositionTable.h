@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+enum TTBound : uint8_t
+{
+    BoundNone,
+    BoundUpper,     // score is at most this (failed low)
+    BoundLower,     // score is at least this (failed high)
+    BoundExact
+};
+
+// what a probe hands back, unpacked
+struct TTData
+{
+    uint16_t    move;       // packed move, 0 if none
+    int16_t     score;
+    int16_t     eval;       // static eval of the position, saves recomputing it
+    int8_t      depth;
+    TTBound     bound;
+};
+
+//
+// one slot in the table
+// the key is stored xor'd with the data, so if two threads write the same slot at the same time
+// and the halves get mixed up, the key check fails on the next probe instead of returning
+// another position's data. that makes the table safe to share without any locks
+//
+struct TTEntry
+{
+    uint64_t    keyXorData;
+    uint64_t    data;
+};
+
+// four entries fill exactly one 64 byte cache line, so a probe is a single memory access
+struct alignas(64) TTCluster
+{
+    TTEntry     entries[4];
+};
+
+//
+// transposition table shared by every search thread
+//
+class TranspositionTable
+{
+public:
+    TranspositionTable();
+    ~TranspositionTable();
+
+    // reallocates and clears; sizes are in megabytes
+    void        resize(size_t megabytes);
+    void        clear();
+    size_t      sizeInMegabytes() const { return _clusterCount * sizeof(TTCluster) / (1024 * 1024); }
+
+    // call once per search so entries from older searches become the first to go
+    void        newSearch() { _generation = (_generation + 1) & 63; }
+
+    // start pulling the cluster for key into cache; call as soon as the key is known
+    void        prefetch(uint64_t key) const;
+    bool        probe(uint64_t key, TTData& data) const;
+    void        store(uint64_t key, int depth, int score, int eval, uint16_t move, TTBound bound);
+
+    // how full the table is in permille, sampled from the first thousand clusters
+    int         hashfull() const;
+
+private:
+    TTCluster*  clusterFor(uint64_t key) const;
+
+    TTCluster*  _clusters;
+    size_t      _clusterCount;
+    uint8_t     _generation;
+};
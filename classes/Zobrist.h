@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+
+//
+// random keys for hashing chess positions
+// a position's key is the xor of the keys for everything in it, so a move only has to
+// xor out what it removes and xor in what it adds. the keys are generated at compile time
+// from a fixed seed, so every build and every run hashes positions the same way
+//
+struct ZobristKeys
+{
+    uint64_t pieceSquare[2][7][64];     // [color][ChessPiece][square], NoPiece slot unused
+    uint64_t castling[16];              // one per combination of CastlingRights bits
+    uint64_t enPassantFile[8];
+    uint64_t blackToMove;
+};
+
+// splitmix64, good enough to give well spread keys from a counter
+constexpr uint64_t zobristRandom(uint64_t& state)
+{
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+constexpr ZobristKeys makeZobristKeys()
+{
+    ZobristKeys keys = {};
+    uint64_t state = 0x5A0B215EED5EEDULL;
+    for (int color = 0; color < 2; color++) {
+        for (int piece = 1; piece < 7; piece++) {
+            for (int square = 0; square < 64; square++) {
+                keys.pieceSquare[color][piece][square] = zobristRandom(state);
+            }
+        }
+    }
+    // no rights hashes to 0 and the four single rights combine by xor, like the bits they stand for
+    uint64_t single[4];
+    for (int i = 0; i < 4; i++) {
+        single[i] = zobristRandom(state);
+    }
+    for (int rights = 0; rights < 16; rights++) {
+        for (int i = 0; i < 4; i++) {
+            if (rights & (1 << i)) {
+                keys.castling[rights] ^= single[i];
+            }
+        }
+    }
+    for (int file = 0; file < 8; file++) {
+        keys.enPassantFile[file] = zobristRandom(state);
+    }
+    keys.blackToMove = zobristRandom(state);
+    return keys;
+}
+
+inline constexpr ZobristKeys Zobrist = makeZobristKeys();
@@ -0,0 +1,111 @@
+// bench: fixed depth search over a set of positions, for measuring search changes without a window
+//
+//   bench [depth] [options]    search the first six perft positions to depth (default 6, or no limit on a clock)
+//
+// options
+//   --fen "<fen>"    search just this position instead
+//   --threads N      lazy SMP over N threads (0 = every core)
+//   --hash MB        transposition table size (default 16)
+//   --nnue <file>    evaluate with this network instead of the piece-square tables
+//   --movetime MS    think this long per position instead of to a fixed depth
+//   --time MS, --inc MS, --movestogo N
+//                    play each position off a clock instead, the way a game would
+//   --no-nullmove, --no-lmr, --no-rfp, --no-futility, --no-aspiration
+//                    turn off null move pruning, late move reductions, reverse futility pruning,
+//                    futility pruning or aspiration windows, to see what each one is worth
+//
+// the node total is a fingerprint of the search: any change that isn't meant to alter the tree
+// should leave it exactly the same
+
+#include "classes/Perft.h"
+#include "classes/Search.h"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+int main(int argc, char** argv)
+{
+    initAttackBitboards();
+
+    int depth = 0;
+    int threads = 1;
+    size_t hashMegabytes = 16;
+    std::vector<std::string> fens;
+    SearchOptions options;
+    SearchLimits limits;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--fen") == 0 && i + 1 < argc) {
+            fens.push_back(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+            if (threads <= 0) {
+                threads = (int)std::thread::hardware_concurrency();
+            }
+        } else if (strcmp(argv[i], "--hash") == 0 && i + 1 < argc) {
+            hashMegabytes = (size_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--nnue") == 0 && i + 1 < argc) {
+            if (!loadNnue(argv[++i])) {
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--movetime") == 0 && i + 1 < argc) {
+            limits.moveTime = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "--time") == 0 && i + 1 < argc) {
+            limits.time = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "--inc") == 0 && i + 1 < argc) {
+            limits.increment = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "--movestogo") == 0 && i + 1 < argc) {
+            limits.movesToGo = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--no-nullmove") == 0) {
+            options.nullMove = false;
+        } else if (strcmp(argv[i], "--no-lmr") == 0) {
+            options.lateMoveReductions = false;
+        } else if (strcmp(argv[i], "--no-rfp") == 0) {
+            options.reverseFutility = false;
+        } else if (strcmp(argv[i], "--no-futility") == 0) {
+            options.futility = false;
+        } else if (strcmp(argv[i], "--no-aspiration") == 0) {
+            options.aspirationWindows = false;
+        } else {
+            depth = atoi(argv[i]);
+        }
+    }
+    if (fens.empty()) {
+        for (int i = 0; i < 6 && i < PerftSuiteSize; i++) {
+            fens.push_back(PerftSuite[i].fen);
+        }
+    }
+
+    Search search;
+    search.setThreads(threads);
+    search.transpositionTable().resize(hashMegabytes);
+    search.setOptions(options);
+    std::cout << "threads: " << threads << ", hash: " << search.transpositionTable().sizeInMegabytes() << " MB" << std::endl;
+    // a clock takes over from the default depth, though an explicit one still caps it
+    if (depth || (!limits.moveTime && !limits.time)) {
+        limits.depth = depth ? depth : 6;
+    }
+
+    uint64_t totalNodes = 0;
+    double totalSeconds = 0.0;
+    Position position;
+    for (const std::string& fen : fens) {
+        std::cout << fen << std::endl;
+        if (!position.setFEN(fen)) {
+            std::cout << "bad FEN: " << fen << std::endl;
+            return 1;
+        }
+        search.transpositionTable().clear();
+        SearchResult result = search.think(position, limits);
+        std::cout << "bestmove " << result.bestMove.notation() << std::endl << std::endl;
+        totalNodes += result.nodes;
+        totalSeconds += result.seconds;
+    }
+
+    std::cout << "nodes: " << totalNodes << std::endl;
+    std::cout << "time: " << (int)(totalSeconds * 1000) << " ms" << std::endl;
+    std::cout << "nps: " << (uint64_t)(totalSeconds > 0 ? totalNodes / totalSeconds : 0) << std::endl;
+    return 0;
+}
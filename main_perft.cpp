@@ -0,0 +1,109 @@
+// perft: move generator correctness and speed check, no window or textures needed
+//
+//   perft <depth> [fen] [options]      divide from the fen (start position if none)
+//   perft suite [maxDepth] [options]   run the standard positions against their known counts (default 5)
+//
+// options
+//   --threads N    split the root moves over N threads (0 = every core)
+//   --hash MB      cache subtree counts in a table of this size
+//   --verify       instead of counting, check the incrementally kept keys, piece-square totals and
+//                  accumulators against a from-scratch setup at every node
+//   --nnue <file>  load a network first, so --verify covers the accumulators too
+
+#include "classes/Nnue.h"
+#include "classes/Perft.h"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+static const char* startFEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+static int usage()
+{
+    std::cout << "usage: perft <depth> [fen] [--threads N] [--hash MB] [--verify] [--nnue file]" << std::endl;
+    std::cout << "       perft suite [maxDepth] [--threads N] [--hash MB] [--verify] [--nnue file]" << std::endl;
+    return 1;
+}
+
+// a whole positive number, 0 for anything else
+static int parseDepth(const char* text)
+{
+    char* end;
+    long depth = strtol(text, &end, 10);
+    return end != text && *end == 0 && depth > 0 && depth < 64 ? (int)depth : 0;
+}
+
+int main(int argc, char** argv)
+{
+    initAttackBitboards();
+
+    if (argc < 2) {
+        return usage();
+    }
+    bool suite = strcmp(argv[1], "suite") == 0;
+    int depth = suite ? 0 : parseDepth(argv[1]);
+    if (!suite && depth == 0) {
+        return usage();
+    }
+
+    int threads = 1;
+    size_t hashMegabytes = 0;
+    bool verify = false;
+    std::string fen;
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+            if (threads <= 0) {
+                threads = (int)std::thread::hardware_concurrency();
+            }
+        } else if (strcmp(argv[i], "--hash") == 0 && i + 1 < argc) {
+            hashMegabytes = (size_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--verify") == 0) {
+            verify = true;
+        } else if (strcmp(argv[i], "--nnue") == 0 && i + 1 < argc) {
+            if (!loadNnue(argv[++i])) {
+                return 1;
+            }
+        } else if (suite) {
+            depth = parseDepth(argv[i]);
+            if (depth == 0) {
+                return usage();
+            }
+        } else {
+            // the fen may come in as one argument or split on its spaces
+            if (!fen.empty()) {
+                fen += ' ';
+            }
+            fen += argv[i];
+        }
+    }
+
+    Position position;
+    if (!suite && !position.setFEN(fen.empty() ? startFEN : fen)) {
+        std::cout << "bad FEN: " << fen << std::endl;
+        return 1;
+    }
+
+    if (verify) {
+        if (suite) {
+            return runVerifySuite(depth ? depth : 3) ? 0 : 1;
+        }
+        return perftVerify(position, depth) ? 0 : 1;
+    }
+
+    std::unique_ptr<PerftHashTable> hash;
+    if (hashMegabytes) {
+        hash = std::make_unique<PerftHashTable>(hashMegabytes);
+    }
+    std::cout << "threads: " << threads << ", hash: " << hashMegabytes << " MB" << std::endl;
+
+    if (suite) {
+        return runPerftSuite(depth ? depth : 5, threads, hash.get()) ? 0 : 1;
+    }
+
+    perftDivide(position, depth, threads, hash.get());
+    return 0;
+}